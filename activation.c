@@ -45,311 +45,999 @@
  */
  
 #include "activation.h"
+#include "internal.h"
 
-Vector ReLU_Vec_wCPU(Vector *Vec_In)
+// Branch-free single precision exp, written so that loops over it auto-vectorize:
+// x = n*ln2 + r with |r| <= ln2/2, exp(r) by a Cephes minimax polynomial and 2^n
+// built directly in the exponent bits, split in two factors that stay normal floats
+// so results overflow to inf and underflow through denormals to zero as expf does.
+// NaN is replaced by 0 before the clamps and the conversion to int, then selected back.
+// DEEPC_FAST_ACTIVATION drops the polynomial to degree 4 (about 4e-5 relative error).
+static inline float activation_expf(float x)
 {
-	Vector tempVec = create_vector(Vec_In->len);
+	int isnan_x = (x != x);
+	
+	float xc = select_float(isnan_x, 0.0f, x);
+	xc = select_float(xc > 89.0f, 89.0f, xc);
+	xc = select_float(xc < -104.0f, -104.0f, xc);
+	
+	// Round x/ln2 to nearest by the 1.5*2^23 trick, ln2 split in hi and lo parts
+	float fn = (xc*1.44269504088896341f + 12582912.0f) - 12582912.0f;
+	float r = xc - fn*0.693359375f;
+	r = r + fn*2.12194440e-4f;
+	
+#ifdef DEEPC_FAST_ACTIVATION
+	float p = 4.1665795894e-2f;
+#else
+	float p = 1.9875691500e-4f;
+	p = p*r + 1.3981999507e-3f;
+	p = p*r + 8.3334519073e-3f;
+	p = p*r + 4.1665795894e-2f;
+#endif
+	p = p*r + 1.6666665459e-1f;
+	p = p*r + 5.0000001201e-1f;
+	p = p*r*r + r + 1.0f;
+	
+	// |n| <= 150, so both halves give biased exponents in [52, 192]
+	int32_t n = (int32_t)fn;
+	int32_t n1 = n/2;
+	union { uint32_t u; float f; } scale1, scale2;
+	
+	scale1.u = (uint32_t)(n1 + 127) << 23;
+	scale2.u = (uint32_t)(n - n1 + 127) << 23;
+	
+	return select_float(isnan_x, x, (p*scale1.f)*scale2.f);
+}
+
+// tanh(x) = x + x^3*P(x^2) for |x| < 0.625 (Cephes), 1 - 2/(exp(2|x|) + 1) otherwise.
+// Both branches are evaluated and blended to keep the loop free of branches.
+static inline float activation_tanhf(float x)
+{
+	float absx = fabsf(x);
+	float z = x*x;
+	
+	float p = -5.70498872745e-3f;
+	p = p*z + 2.06390887954e-2f;
+	p = p*z - 5.37397155531e-2f;
+	p = p*z + 1.33314422036e-1f;
+	p = p*z - 3.33332819422e-1f;
+	
+	float small = x + x*z*p;
+	float large = 1.0f - 2.0f/(activation_expf(2.0f*absx) + 1.0f);
+	
+	large = select_float(x < 0, -large, large);
+	
+	return select_float(absx < 0.625f, small, large);
+}
+
+// sigmoid(x) = 1/(1 + e) for x >= 0 and e/(1 + e) for x < 0 with e = exp(-|x|), so
+// exp never overflows and the tail for negative x goes down through denormals like expf
+static inline float activation_sigmoidf(float x)
+{
+	float e = activation_expf(-fabsf(x));
+	
+	return select_float(x < 0.0f, e, 1.0f)/(1.0f + e);
+}
+
+// Finite stand-in for x = -inf in x*f(x) and x/g(x) forms whose factor goes to 0
+// there, so GELU, SiLU, Mish and HardSwish give -0 instead of -inf*0 = NaN
+static inline float activation_finite_neg(float x)
+{
+	return select_float(x < -FLT_MAX, -FLT_MAX, x);
+}
+
+// GELU with the exact normal CDF: Phi(x) = 1 - erfc(x/sqrt(2))/2, erfc of |x| by the
+// Chebyshev fit of Numerical Recipes (1.2e-7 relative error on its own), so the tail 
+// for negative x keeps its precision instead of cancelling in 1 + erf(x)
+static inline float activation_geluf(float x)
+{
+	float z = fabsf(x)*0.70710678118654752f;
+	float t = 1.0f/(1.0f + 0.5f*z);
+	
+	float p = 0.17087277f;
+	p = p*t - 0.82215223f;
+	p = p*t + 1.48851587f;
+	p = p*t - 1.13520398f;
+	p = p*t + 0.27886807f;
+	p = p*t - 0.18628806f;
+	p = p*t + 0.09678418f;
+	p = p*t + 0.37409196f;
+	p = p*t + 1.00002368f;
+	p = p*t - 1.26551223f;
+	
+	float q = t*activation_expf(p - z*z);
+	
+	return activation_finite_neg(x)*select_float(x > 0.0f, 1.0f - 0.5f*q, 0.5f*q);
+}
+
+// GELU with the tanh approximation, using 1 + tanh(u) = 2*sigmoid(2u)
+static inline float activation_gelu_tanhf(float x)
+{
+	float u = 0.79788456080286536f*(x + 0.044715f*x*x*x);
+	
+	return activation_finite_neg(x)/(1.0f + activation_expf(-2.0f*u));
+}
+
+static inline float activation_siluf(float x)
+{
+	return activation_finite_neg(x)/(1.0f + activation_expf(-x));
+}
+
+// tanh(softplus(x)) = n/(n + 2) with n = e^x*(e^x + 2); beyond x = 20 the ratio is 1
+// in single precision and clamping keeps n finite
+static inline float activation_mishf(float x)
+{
+	float e = activation_expf(select_float(x > 20.0f, 20.0f, x));
+	float n = e*(e + 2.0f);
 	
-	for (int i = 0; i < Vec_In->len; i++)
+	return activation_finite_neg(x)*n/(n + 2.0f);
+}
+
+static inline float activation_hardswishf(float x)
+{
+	float r = x + 3.0f;
+	
+	r = select_float(r > 0.0f, r, 0.0f);
+	r = select_float(r < 6.0f, r, 6.0f);
+	
+	return activation_finite_neg(x)*r*(1.0f/6.0f);
+}
+
+// All element-wise activations behind one kernel, in and out may be the same row.
+// Each case is branch-free per element so the loops vectorize.
+static void activation_type_row(const float *in, float *out, int len, Activation_Type type, float slope)
+{
+	switch (type)
 	{
-		if (Vec_In->vals[i] > 0)
-		{
-			tempVec.vals[i] = Vec_In->vals[i];
-		}
-		else
-		{    
-			tempVec.vals[i] = 0;
-		}
+		case ACTIVATION_RELU:
+			for (int j = 0; j < len; j++)
+			{
+				out[j] = select_float(in[j] > 0.0f, in[j], 0.0f);
+			}
+			break;
+		
+		case ACTIVATION_RELU6:
+			for (int j = 0; j < len; j++)
+			{
+				float x = select_float(in[j] > 0.0f, in[j], 0.0f);
+				out[j] = select_float(x < 6.0f, x, 6.0f);
+			}
+			break;
+		
+		case ACTIVATION_LEAKY_RELU:
+			for (int j = 0; j < len; j++)
+			{
+				out[j] = select_float(in[j] > 0.0f, in[j], slope*in[j]);
+			}
+			break;
+		
+		case ACTIVATION_SIGMOID:
+			for (int j = 0; j < len; j++)
+			{
+				out[j] = activation_sigmoidf(in[j]);
+			}
+			break;
+		
+		case ACTIVATION_TANH:
+			for (int j = 0; j < len; j++)
+			{
+				out[j] = activation_tanhf(in[j]);
+			}
+			break;
+		
+		case ACTIVATION_GELU:
+			for (int j = 0; j < len; j++)
+			{
+				out[j] = activation_geluf(in[j]);
+			}
+			break;
+		
+		case ACTIVATION_GELU_TANH:
+			for (int j = 0; j < len; j++)
+			{
+				out[j] = activation_gelu_tanhf(in[j]);
+			}
+			break;
+		
+		case ACTIVATION_SILU:
+			for (int j = 0; j < len; j++)
+			{
+				out[j] = activation_siluf(in[j]);
+			}
+			break;
+		
+		case ACTIVATION_MISH:
+			for (int j = 0; j < len; j++)
+			{
+				out[j] = activation_mishf(in[j]);
+			}
+			break;
+		
+		case ACTIVATION_HARDSWISH:
+			for (int j = 0; j < len; j++)
+			{
+				out[j] = activation_hardswishf(in[j]);
+			}
+			break;
+		
+		default:
+			if (out != in)
+			{
+				memcpy(out, in, len * sizeof(float));
+			}
+			break;
+	}
+}
+
+typedef void (*activation_row_fn)(const float *in, float *out, int len);
+
+static void exp_row(const float *in, float *out, int len)
+{
+	for (int j = 0; j < len; j++)
+	{
+		out[j] = activation_expf(in[j]);
+	}
+}
+
+static void tanh_row(const float *in, float *out, int len)
+{
+	for (int j = 0; j < len; j++)
+	{
+		out[j] = activation_tanhf(in[j]);
 	}
+}
+
+static void sigmoid_row(const float *in, float *out, int len)
+{
+	for (int j = 0; j < len; j++)
+	{
+		out[j] = activation_sigmoidf(in[j]);
+	}
+}
+
+static void relu_row(const float *in, float *out, int len)
+{
+	activation_type_row(in, out, len, ACTIVATION_RELU, 0.0f);
+}
+
+static void relu6_row(const float *in, float *out, int len)
+{
+	activation_type_row(in, out, len, ACTIVATION_RELU6, 0.0f);
+}
+
+static void gelu_row(const float *in, float *out, int len)
+{
+	activation_type_row(in, out, len, ACTIVATION_GELU, 0.0f);
+}
+
+static void gelu_tanh_row(const float *in, float *out, int len)
+{
+	activation_type_row(in, out, len, ACTIVATION_GELU_TANH, 0.0f);
+}
+
+static void silu_row(const float *in, float *out, int len)
+{
+	activation_type_row(in, out, len, ACTIVATION_SILU, 0.0f);
+}
+
+static void mish_row(const float *in, float *out, int len)
+{
+	activation_type_row(in, out, len, ACTIVATION_MISH, 0.0f);
+}
+
+static void hardswish_row(const float *in, float *out, int len)
+{
+	activation_type_row(in, out, len, ACTIVATION_HARDSWISH, 0.0f);
+}
+
+// Online softmax normalizer: (maxval, sumval) describes sum(exp(x - maxval)) over the
+// elements seen so far. One exp per element, exp(-|x - maxval|), is either added to
+// the sum or used to rescale it when x becomes the new maximum. Equal values
+// (including both -inf) give a difference of 0 instead of NaN.
+static inline void softmax_online_update(float *maxval, float *sumval, float x)
+{
+	float d = select_float(x == *maxval, 0.0f, x - *maxval);
+	float e = activation_expf(-fabsf(d));
+	int greater = x > *maxval;
 	
-	return tempVec;
+	*sumval = select_float(greater, *sumval*e + 1.0f, *sumval + e);
+	*maxval = select_float(greater, x, *maxval);
 }
 
-Matrix ReLU_Mat_wCPU(Matrix *Mat_In)
+static inline void softmax_online_merge(float *maxval, float *sumval, float othermax, float othersum)
 {
-    Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
-        
-    for (int i = 0; i < Mat_In->row; i++)
-    {
-        for (int j = 0; j < Mat_In->col; j++)
-        {
-            if (Mat_In->vals[i][j] > 0)
-            {
-                tempMat.vals[i][j] = Mat_In->vals[i][j];
-            }
-            else
-            {    
-                tempMat.vals[i][j] = 0;
-            }
-        }
-    }
-    
-    return tempMat;
+	float m = (othermax > *maxval) ? othermax : *maxval;
+	float d1 = (*maxval == m) ? 0.0f : *maxval - m;
+	float d2 = (othermax == m) ? 0.0f : othermax - m;
+	
+	*sumval = *sumval*activation_expf(d1) + othersum*activation_expf(d2);
+	*maxval = m;
 }
 
-Tensor ReLU_Tsr_wCPU(Tensor *Tsr_In)
+// Normalizer of one contiguous row in a single pass, with 8 independent lanes
+// merged at the end so the update vectorizes
+static void softmax_row_stats(const float *in, int len, float *maxval, float *sumval)
 {
-    Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
-        
-    for(int k = 0; k < Tsr_In->depth; k++)
-    {
-		for (int i = 0; i < Tsr_In->row; i++)
+	float lanemax[8], lanesum[8];
+	
+	for (int l = 0; l < 8; l++)
+	{
+		lanemax[l] = -INFINITY;
+		lanesum[l] = 0.0f;
+	}
+	
+	int j = 0;
+	
+	for (; j + 8 <= len; j += 8)
+	{
+		for (int l = 0; l < 8; l++)
 		{
-			for (int j = 0; j < Tsr_In->col; j++)
-			{
-				if (Tsr_In->vals[k][i][j] > 0)
-				{
-					tempTsr.vals[k][i][j] = Tsr_In->vals[k][i][j];
-				}
-				else
-				{    
-					tempTsr.vals[k][i][j] = 0;
-				}
-			}
+			softmax_online_update(&lanemax[l], &lanesum[l], in[j + l]);
 		}
 	}
-    
-    return tempTsr;
+	
+	for (int l = 0; j < len; j++, l++)
+	{
+		softmax_online_update(&lanemax[l], &lanesum[l], in[j]);
+	}
+	
+	for (int l = 1; l < 8; l++)
+	{
+		softmax_online_merge(&lanemax[0], &lanesum[0], lanemax[l], lanesum[l]);
+	}
+	
+	*maxval = lanemax[0];
+	*sumval = lanesum[0];
 }
 
-Vector Leaky_ReLU_Vec_wCPU(Vector *Vec_In)
+static void softmax_row_output(const float *in, float *out, int len, float maxval, float sumval, int log_mode)
 {
-	Vector tempVec = create_vector(Vec_In->len);
+	if (log_mode)
+	{
+		float logsum = logf(sumval);
+		
+		for (int j = 0; j < len; j++)
+		{
+			out[j] = select_float(in[j] == maxval, 0.0f, in[j] - maxval) - logsum;
+		}
+	}
+	else
+	{
+		float inv = 1.0f/sumval;
+		
+		for (int j = 0; j < len; j++)
+		{
+			out[j] = activation_expf(select_float(in[j] == maxval, 0.0f, in[j] - maxval))*inv;
+		}
+	}
+}
+
+#define SOFTMAX_COL_BLOCK 256
+
+// Softmax across count rows, i.e. down each column, for columns [j0, j1) with
+// j1 - j0 <= SOFTMAX_COL_BLOCK. Columns are independent, so the update vectorizes
+// along the rows and the normalizers of the block stay on the stack.
+static void softmax_cols_block(float **inrows, float **outrows, int count, int j0, int j1, int log_mode)
+{
+	float colmax[SOFTMAX_COL_BLOCK], colsum[SOFTMAX_COL_BLOCK];
+	int width = j1 - j0;
+	
+	for (int j = 0; j < width; j++)
+	{
+		colmax[j] = -INFINITY;
+		colsum[j] = 0.0f;
+	}
 	
-	for (int i = 0; i < Vec_In->len; i++)
+	for (int i = 0; i < count; i++)
 	{
-		if (Vec_In->vals[i] > 0)
+		const float *in = inrows[i] + j0;
+		
+		for (int j = 0; j < width; j++)
 		{
-			tempVec.vals[i] = Vec_In->vals[i];
+			softmax_online_update(&colmax[j], &colsum[j], in[j]);
+		}
+	}
+	
+	for (int j = 0; j < width; j++)
+	{
+		colsum[j] = log_mode ? logf(colsum[j]) : 1.0f/colsum[j];
+	}
+	
+	for (int i = 0; i < count; i++)
+	{
+		const float *in = inrows[i] + j0;
+		float *out = outrows[i] + j0;
+		
+		if (log_mode)
+		{
+			for (int j = 0; j < width; j++)
+			{
+				out[j] = select_float(in[j] == colmax[j], 0.0f, in[j] - colmax[j]) - colsum[j];
+			}
 		}
 		else
-		{    
-			tempVec.vals[i] = 0.01*Vec_In->vals[i];
+		{
+			for (int j = 0; j < width; j++)
+			{
+				out[j] = activation_expf(select_float(in[j] == colmax[j], 0.0f, in[j] - colmax[j]))*colsum[j];
+			}
 		}
 	}
+}
+
+// Softmax over all rows of all layers taken together as one set of values
+static void softmax_all_rows(float ***inlayers, float ***outlayers, int depth, int count, int len, int log_mode)
+{
+	float maxval = -INFINITY, sumval = 0.0f;
 	
-	return tempVec;
+	for (int n = 0; n < depth*count; n++)
+	{
+		float rowmax, rowsum;
+		
+		softmax_row_stats(inlayers[n / count][n % count], len, &rowmax, &rowsum);
+		softmax_online_merge(&maxval, &sumval, rowmax, rowsum);
+	}
+	
+	#pragma omp parallel for
+	for (int n = 0; n < depth*count; n++)
+	{
+		softmax_row_output(inlayers[n / count][n % count], outlayers[n / count][n % count], len, maxval, sumval, log_mode);
+	}
 }
 
-Matrix Leaky_ReLU_Mat_wCPU(Matrix *Mat_In)
+static Matrix softmax_axis_Mat(Matrix *Mat_In, int axis, int log_mode)
 {
-    Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
-    
-    for (int i = 0; i < Mat_In->row; i++)
-    {
-        for (int j = 0; j < Mat_In->col; j++)
-        {
-            if (Mat_In->vals[i][j] > 0)
-            {
-                tempMat.vals[i][j] = Mat_In->vals[i][j];
-            }
-            else
-            {    
-                tempMat.vals[i][j] = 0.01*Mat_In->vals[i][j];
-            }
-        }
-    }
-    
-    return tempMat;
+	assert(axis == 0 || axis == 1);
+	
+	Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
+	
+	if (axis == 1)
+	{
+		#pragma omp parallel for
+		for (int i = 0; i < Mat_In->row; i++)
+		{
+			float maxval, sumval;
+			
+			softmax_row_stats(Mat_In->vals[i], Mat_In->col, &maxval, &sumval);
+			softmax_row_output(Mat_In->vals[i], tempMat.vals[i], Mat_In->col, maxval, sumval, log_mode);
+		}
+	}
+	else
+	{
+		int nblocks = (Mat_In->col + SOFTMAX_COL_BLOCK - 1)/SOFTMAX_COL_BLOCK;
+		
+		#pragma omp parallel for
+		for (int b = 0; b < nblocks; b++)
+		{
+			int j0 = b*SOFTMAX_COL_BLOCK;
+			int j1 = (j0 + SOFTMAX_COL_BLOCK < Mat_In->col) ? j0 + SOFTMAX_COL_BLOCK : Mat_In->col;
+			
+			softmax_cols_block(Mat_In->vals, tempMat.vals, Mat_In->row, j0, j1, log_mode);
+		}
+	}
+	
+	return tempMat;
 }
 
-Tensor Leaky_ReLU_Tsr_wCPU(Tensor *Tsr_In)
+static Tensor softmax_axis_Tsr(Tensor *Tsr_In, int axis, int log_mode)
 {
-    Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
-    
-    for(int k = 0; k < Tsr_In->depth; k++)
-    {
+	assert(axis >= 0 && axis <= 2);
+	
+	Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
+	
+	int nblocks = (Tsr_In->col + SOFTMAX_COL_BLOCK - 1)/SOFTMAX_COL_BLOCK;
+	
+	if (axis == 2)
+	{
+		#pragma omp parallel for
+		for (int n = 0; n < Tsr_In->depth*Tsr_In->row; n++)
+		{
+			float *in = Tsr_In->vals[n / Tsr_In->row][n % Tsr_In->row];
+			float *out = tempTsr.vals[n / Tsr_In->row][n % Tsr_In->row];
+			float maxval, sumval;
+			
+			softmax_row_stats(in, Tsr_In->col, &maxval, &sumval);
+			softmax_row_output(in, out, Tsr_In->col, maxval, sumval, log_mode);
+		}
+	}
+	else if (axis == 1)
+	{
+		// Down the rows of each layer
+		#pragma omp parallel for
+		for (int n = 0; n < Tsr_In->depth*nblocks; n++)
+		{
+			int k = n / nblocks;
+			int j0 = (n % nblocks)*SOFTMAX_COL_BLOCK;
+			int j1 = (j0 + SOFTMAX_COL_BLOCK < Tsr_In->col) ? j0 + SOFTMAX_COL_BLOCK : Tsr_In->col;
+			
+			softmax_cols_block(Tsr_In->vals[k], tempTsr.vals[k], Tsr_In->row, j0, j1, log_mode);
+		}
+	}
+	else
+	{
+		// Across the layers at each position: gather row i of every layer
+		#pragma omp parallel for
 		for (int i = 0; i < Tsr_In->row; i++)
 		{
-			for (int j = 0; j < Tsr_In->col; j++)
+			float **inrows = malloc(Tsr_In->depth * sizeof(float *));
+			float **outrows = malloc(Tsr_In->depth * sizeof(float *));
+			
+			for (int k = 0; k < Tsr_In->depth; k++)
 			{
-				if (Tsr_In->vals[k][i][j] > 0)
-				{
-					tempTsr.vals[k][i][j] = Tsr_In->vals[k][i][j];
-				}
-				else
-				{    
-					tempTsr.vals[k][i][j] = 0.01*Tsr_In->vals[k][i][j];
-				}
+				inrows[k] = Tsr_In->vals[k][i];
+				outrows[k] = tempTsr.vals[k][i];
 			}
+			
+			for (int b = 0; b < nblocks; b++)
+			{
+				int j0 = b*SOFTMAX_COL_BLOCK;
+				int j1 = (j0 + SOFTMAX_COL_BLOCK < Tsr_In->col) ? j0 + SOFTMAX_COL_BLOCK : Tsr_In->col;
+				
+				softmax_cols_block(inrows, outrows, Tsr_In->depth, j0, j1, log_mode);
+			}
+			
+			free(inrows);
+			free(outrows);
 		}
 	}
-    
-    return tempTsr;
+	
+	return tempTsr;
 }
 
-Vector softmax_Vec_wCPU(Vector *Vec_In)
+static Vector activation_Vec(Vector *Vec_In, activation_row_fn rowfn)
 {
 	Vector tempVec = create_vector(Vec_In->len);
 	
-	float temp[Vec_In->len];
-    double tempsum = 0;
+	rowfn(Vec_In->vals, tempVec.vals, Vec_In->len);
 	
-	for (int i = 0; i < Vec_In->len; i++)
+	return tempVec;
+}
+
+static Matrix activation_Mat(Matrix *Mat_In, activation_row_fn rowfn)
+{
+	Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
+	
+	#pragma omp parallel for
+	for (int i = 0; i < Mat_In->row; i++)
 	{
-		temp[i] = exp(Vec_In->vals[i]);
-		tempsum += temp[i];
+		rowfn(Mat_In->vals[i], tempMat.vals[i], Mat_In->col);
 	}
 	
-	for (int i = 0; i < Vec_In->len; i++)
+	return tempMat;
+}
+
+static Tensor activation_Tsr(Tensor *Tsr_In, activation_row_fn rowfn)
+{
+	Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
+	
+	// Rows of all layers are independent, so split them over threads as one range
+	#pragma omp parallel for
+	for (int n = 0; n < Tsr_In->depth*Tsr_In->row; n++)
 	{
-		tempVec.vals[i] = temp[i]/tempsum;
+		int k = n / Tsr_In->row;
+		int i = n % Tsr_In->row;
+		
+		rowfn(Tsr_In->vals[k][i], tempTsr.vals[k][i], Tsr_In->col);
 	}
 	
-	return tempVec;
+	return tempTsr;
 }
 
-Matrix softmax_Mat_wCPU(Matrix *Mat_In)
+void activation_inplace_Vec_wCPU(Vector *Vec, Activation_Type type, float slope)
 {
-    Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
-    
-    float temp[Mat_In->row][Mat_In->col];
-    double tempsum = 0;
-    
-    for(int i = 0; i < Mat_In->row; i++)
-    {
-        for(int j = 0; j < Mat_In->col; j++)
-        {
-            temp[i][j] = exp(Mat_In->vals[i][j]);
-            tempsum += temp[i][j];
-        }
-    }
-    
-    for(int i = 0; i < Mat_In->row; i++)
-    {
-        for(int j = 0; j < Mat_In->col; j++)
-        {
-            tempMat.vals[i][j] = temp[i][j]/tempsum;
-        }
-    }
-    
-    return tempMat;
+	activation_type_row(Vec->vals, Vec->vals, Vec->len, type, slope);
 }
 
-Tensor softmax_Tsr_wCPU(Tensor *Tsr_In)
+void activation_inplace_Mat_wCPU(Matrix *Mat, Activation_Type type, float slope)
 {
-    Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
-    
-    float temp[Tsr_In->row][Tsr_In->col][Tsr_In->depth];
-    double tempsum = 0;
-    
-    for(int k = 0; k < Tsr_In->depth; k++)
-    {
-		for(int i = 0; i < Tsr_In->row; i++)
-		{
-			for(int j = 0; j < Tsr_In->col; j++)
-			{
-				temp[k][i][j] = exp(Tsr_In->vals[k][i][j]);
-				tempsum += temp[k][i][j];
-			}
-		}
+	#pragma omp parallel for
+	for (int i = 0; i < Mat->row; i++)
+	{
+		activation_type_row(Mat->vals[i], Mat->vals[i], Mat->col, type, slope);
 	}
-    
-    for(int k = 0; k < Tsr_In->depth; k++)
-    {
-		for(int i = 0; i < Tsr_In->row; i++)
-		{
-			for(int j = 0; j < Tsr_In->col; j++)
-			{
-				tempTsr.vals[k][i][j] = temp[k][i][j]/tempsum;
-			}
-		}
+}
+
+void activation_inplace_Tsr_wCPU(Tensor *Tsr, Activation_Type type, float slope)
+{
+	#pragma omp parallel for
+	for (int n = 0; n < Tsr->depth*Tsr->row; n++)
+	{
+		float *row = Tsr->vals[n / Tsr->row][n % Tsr->row];
+		
+		activation_type_row(row, row, Tsr->col, type, slope);
 	}
-    
-    return tempTsr;
 }
 
-Vector tanh_Vec_wCPU(Vector *Vec_In)
+void activation_inplace_row_wCPU(float *vals, int len, Activation_Type type, float slope)
+{
+	activation_type_row(vals, vals, len, type, slope);
+}
+
+Vector ReLU_Vec_wCPU(Vector *Vec_In)
+{
+	return activation_Vec(Vec_In, relu_row);
+}
+
+Matrix ReLU_Mat_wCPU(Matrix *Mat_In)
+{
+	return activation_Mat(Mat_In, relu_row);
+}
+
+Tensor ReLU_Tsr_wCPU(Tensor *Tsr_In)
+{
+	return activation_Tsr(Tsr_In, relu_row);
+}
+
+Vector Leaky_ReLU_Vec_wCPU(Vector *Vec_In)
+{
+	return Leaky_ReLU_slope_Vec_wCPU(Vec_In, 0.01f);
+}
+
+Vector Leaky_ReLU_slope_Vec_wCPU(Vector *Vec_In, float slope)
 {
 	Vector tempVec = create_vector(Vec_In->len);
 	
-	for (int i = 0; i < Vec_In->len; i++)
+	activation_type_row(Vec_In->vals, tempVec.vals, Vec_In->len, ACTIVATION_LEAKY_RELU, slope);
+	
+	return tempVec;
+}
+
+Matrix Leaky_ReLU_Mat_wCPU(Matrix *Mat_In)
+{
+	return Leaky_ReLU_slope_Mat_wCPU(Mat_In, 0.01f);
+}
+
+Matrix Leaky_ReLU_slope_Mat_wCPU(Matrix *Mat_In, float slope)
+{
+	Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
+	
+	#pragma omp parallel for
+	for (int i = 0; i < Mat_In->row; i++)
 	{
-		tempVec.vals[i] = 2.0/(1.0 + exp(-2 * Vec_In->vals[i])) - 1;
+		activation_type_row(Mat_In->vals[i], tempMat.vals[i], Mat_In->col, ACTIVATION_LEAKY_RELU, slope);
 	}
 	
-	return tempVec;
+	return tempMat;
 }
 
-Matrix tanh_Mat_wCPU(Matrix *Mat_In)
+Tensor Leaky_ReLU_Tsr_wCPU(Tensor *Tsr_In)
 {
-    Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
-    
-    for (int i = 0; i < Mat_In->row; i++)
-    {
-        for(int j = 0; j < Mat_In->col; j++)
-        {
-            tempMat.vals[i][j] = 2.0/(1.0 + exp(-2 * Mat_In->vals[i][j])) - 1;
-        }
-    }
-    
-    return tempMat;
+	return Leaky_ReLU_slope_Tsr_wCPU(Tsr_In, 0.01f);
 }
 
-Tensor tanh_Tsr_wCPU(Tensor *Tsr_In)
+Tensor Leaky_ReLU_slope_Tsr_wCPU(Tensor *Tsr_In, float slope)
 {
-    Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
-    
-    for (int k = 0; k < Tsr_In->depth; k++)
-    {
-		for (int i = 0; i < Tsr_In->row; i++)
-		{
-			for(int j = 0; j < Tsr_In->col; j++)
-			{
-				tempTsr.vals[k][i][j] = 2.0/(1.0 + exp(-2 * Tsr_In->vals[k][i][j])) - 1;
-			}
-		}
+	Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
+	
+	#pragma omp parallel for
+	for (int n = 0; n < Tsr_In->depth*Tsr_In->row; n++)
+	{
+		int k = n / Tsr_In->row;
+		int i = n % Tsr_In->row;
+		
+		activation_type_row(Tsr_In->vals[k][i], tempTsr.vals[k][i], Tsr_In->col, ACTIVATION_LEAKY_RELU, slope);
 	}
-    
-    return tempTsr;
+	
+	return tempTsr;
 }
 
+Vector ReLU6_Vec_wCPU(Vector *Vec_In)
+{
+	return activation_Vec(Vec_In, relu6_row);
+}
 
+Matrix ReLU6_Mat_wCPU(Matrix *Mat_In)
+{
+	return activation_Mat(Mat_In, relu6_row);
+}
 
-Vector sigmoid_Vec_wCPU(Vector *Vec_In)
+Tensor ReLU6_Tsr_wCPU(Tensor *Tsr_In)
 {
-	Vector tempVec = create_vector(Vec_In->len);
+	return activation_Tsr(Tsr_In, relu6_row);
+}
+
+void ReLU_inplace_Vec_wCPU(Vector *Vec)
+{
+	activation_inplace_Vec_wCPU(Vec, ACTIVATION_RELU, 0.0f);
+}
+
+void ReLU_inplace_Mat_wCPU(Matrix *Mat)
+{
+	activation_inplace_Mat_wCPU(Mat, ACTIVATION_RELU, 0.0f);
+}
+
+void ReLU_inplace_Tsr_wCPU(Tensor *Tsr)
+{
+	activation_inplace_Tsr_wCPU(Tsr, ACTIVATION_RELU, 0.0f);
+}
+
+void ReLU6_inplace_Vec_wCPU(Vector *Vec)
+{
+	activation_inplace_Vec_wCPU(Vec, ACTIVATION_RELU6, 0.0f);
+}
+
+void ReLU6_inplace_Mat_wCPU(Matrix *Mat)
+{
+	activation_inplace_Mat_wCPU(Mat, ACTIVATION_RELU6, 0.0f);
+}
+
+void ReLU6_inplace_Tsr_wCPU(Tensor *Tsr)
+{
+	activation_inplace_Tsr_wCPU(Tsr, ACTIVATION_RELU6, 0.0f);
+}
+
+void Leaky_ReLU_inplace_Vec_wCPU(Vector *Vec, float slope)
+{
+	activation_inplace_Vec_wCPU(Vec, ACTIVATION_LEAKY_RELU, slope);
+}
+
+void Leaky_ReLU_inplace_Mat_wCPU(Matrix *Mat, float slope)
+{
+	activation_inplace_Mat_wCPU(Mat, ACTIVATION_LEAKY_RELU, slope);
+}
+
+void Leaky_ReLU_inplace_Tsr_wCPU(Tensor *Tsr, float slope)
+{
+	activation_inplace_Tsr_wCPU(Tsr, ACTIVATION_LEAKY_RELU, slope);
+}
+
+Tensor PReLU_Tsr_wCPU(Tensor *Tsr_In, Vector *Vec_Slopes)
+{
+	assert(Vec_Slopes->len == Tsr_In->depth);
+	
+	Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
 	
-	for (int i = 0; i < Vec_In->len; i++)
+	#pragma omp parallel for
+	for (int n = 0; n < Tsr_In->depth*Tsr_In->row; n++)
 	{
-		tempVec.vals[i] = 1.0/(1.0 + exp(-Vec_In->vals[i]));
+		int k = n / Tsr_In->row;
+		int i = n % Tsr_In->row;
+		
+		activation_type_row(Tsr_In->vals[k][i], tempTsr.vals[k][i], Tsr_In->col, ACTIVATION_LEAKY_RELU, Vec_Slopes->vals[k]);
 	}
 	
+	return tempTsr;
+}
+
+void PReLU_inplace_Tsr_wCPU(Tensor *Tsr, Vector *Vec_Slopes)
+{
+	assert(Vec_Slopes->len == Tsr->depth);
+	
+	#pragma omp parallel for
+	for (int n = 0; n < Tsr->depth*Tsr->row; n++)
+	{
+		float *row = Tsr->vals[n / Tsr->row][n % Tsr->row];
+		
+		activation_type_row(row, row, Tsr->col, ACTIVATION_LEAKY_RELU, Vec_Slopes->vals[n / Tsr->row]);
+	}
+}
+
+Vector softmax_Vec_wCPU(Vector *Vec_In)
+{
+	Vector tempVec = create_vector(Vec_In->len);
+	
+	float maxval, sumval;
+	
+	softmax_row_stats(Vec_In->vals, Vec_In->len, &maxval, &sumval);
+	softmax_row_output(Vec_In->vals, tempVec.vals, Vec_In->len, maxval, sumval, 0);
+	
 	return tempVec;
 }
 
-Matrix sigmoid_Mat_wCPU(Matrix *Mat_In)
+Matrix softmax_Mat_wCPU(Matrix *Mat_In)
 {
     Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
     
-    for(int i = 0; i < Mat_In->row; i++)
-    {
-        for(int j = 0; j < Mat_In->col; j++)
-        {
-            tempMat.vals[i][j] = 1.0/(1.0 + exp(-Mat_In->vals[i][j]));
-        }
-    }
+    softmax_all_rows(&Mat_In->vals, &tempMat.vals, 1, Mat_In->row, Mat_In->col, 0);
     
     return tempMat;
 }
 
-Tensor sigmoid_Tsr_wCPU(Tensor *Tsr_In)
+Tensor softmax_Tsr_wCPU(Tensor *Tsr_In)
 {
     Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
     
-    for(int k = 0; k < Tsr_In->depth; k++)
-    {
-		for(int i = 0; i < Tsr_In->row; i++)
-		{
-			for(int j = 0; j < Tsr_In->col; j++)
-			{
-				tempTsr.vals[k][i][j] = 1.0/(1.0 + exp(-Tsr_In->vals[k][i][j]));
-			}
-		}
-	}
+    softmax_all_rows(Tsr_In->vals, tempTsr.vals, Tsr_In->depth, Tsr_In->row, Tsr_In->col, 0);
     
     return tempTsr;
 }
 
+Vector tanh_Vec_wCPU(Vector *Vec_In)
+{
+	return activation_Vec(Vec_In, tanh_row);
+}
+
+Matrix tanh_Mat_wCPU(Matrix *Mat_In)
+{
+	return activation_Mat(Mat_In, tanh_row);
+}
+
+Tensor tanh_Tsr_wCPU(Tensor *Tsr_In)
+{
+	return activation_Tsr(Tsr_In, tanh_row);
+}
+
+Vector sigmoid_Vec_wCPU(Vector *Vec_In)
+{
+	return activation_Vec(Vec_In, sigmoid_row);
+}
+
+Matrix sigmoid_Mat_wCPU(Matrix *Mat_In)
+{
+	return activation_Mat(Mat_In, sigmoid_row);
+}
+
+Tensor sigmoid_Tsr_wCPU(Tensor *Tsr_In)
+{
+	return activation_Tsr(Tsr_In, sigmoid_row);
+}
+
+Vector exp_Vec_wCPU(Vector *Vec_In)
+{
+	return activation_Vec(Vec_In, exp_row);
+}
+
+Matrix exp_Mat_wCPU(Matrix *Mat_In)
+{
+	return activation_Mat(Mat_In, exp_row);
+}
+
+Tensor exp_Tsr_wCPU(Tensor *Tsr_In)
+{
+	return activation_Tsr(Tsr_In, exp_row);
+}
+
+Vector log_softmax_Vec_wCPU(Vector *Vec_In)
+{
+	Vector tempVec = create_vector(Vec_In->len);
+	
+	float maxval, sumval;
+	
+	softmax_row_stats(Vec_In->vals, Vec_In->len, &maxval, &sumval);
+	softmax_row_output(Vec_In->vals, tempVec.vals, Vec_In->len, maxval, sumval, 1);
+	
+	return tempVec;
+}
+
+Matrix softmax_axis_Mat_wCPU(Matrix *Mat_In, int axis)
+{
+	return softmax_axis_Mat(Mat_In, axis, 0);
+}
+
+Matrix log_softmax_axis_Mat_wCPU(Matrix *Mat_In, int axis)
+{
+	return softmax_axis_Mat(Mat_In, axis, 1);
+}
 
+Tensor softmax_axis_Tsr_wCPU(Tensor *Tsr_In, int axis)
+{
+	return softmax_axis_Tsr(Tsr_In, axis, 0);
+}
 
+Tensor log_softmax_axis_Tsr_wCPU(Tensor *Tsr_In, int axis)
+{
+	return softmax_axis_Tsr(Tsr_In, axis, 1);
+}
+
+Vector GELU_Vec_wCPU(Vector *Vec_In)
+{
+	return activation_Vec(Vec_In, gelu_row);
+}
+
+Matrix GELU_Mat_wCPU(Matrix *Mat_In)
+{
+	return activation_Mat(Mat_In, gelu_row);
+}
+
+Tensor GELU_Tsr_wCPU(Tensor *Tsr_In)
+{
+	return activation_Tsr(Tsr_In, gelu_row);
+}
+
+Vector GELU_tanh_Vec_wCPU(Vector *Vec_In)
+{
+	return activation_Vec(Vec_In, gelu_tanh_row);
+}
+
+Matrix GELU_tanh_Mat_wCPU(Matrix *Mat_In)
+{
+	return activation_Mat(Mat_In, gelu_tanh_row);
+}
+
+Tensor GELU_tanh_Tsr_wCPU(Tensor *Tsr_In)
+{
+	return activation_Tsr(Tsr_In, gelu_tanh_row);
+}
+
+Vector SiLU_Vec_wCPU(Vector *Vec_In)
+{
+	return activation_Vec(Vec_In, silu_row);
+}
+
+Matrix SiLU_Mat_wCPU(Matrix *Mat_In)
+{
+	return activation_Mat(Mat_In, silu_row);
+}
+
+Tensor SiLU_Tsr_wCPU(Tensor *Tsr_In)
+{
+	return activation_Tsr(Tsr_In, silu_row);
+}
+
+Vector Mish_Vec_wCPU(Vector *Vec_In)
+{
+	return activation_Vec(Vec_In, mish_row);
+}
+
+Matrix Mish_Mat_wCPU(Matrix *Mat_In)
+{
+	return activation_Mat(Mat_In, mish_row);
+}
+
+Tensor Mish_Tsr_wCPU(Tensor *Tsr_In)
+{
+	return activation_Tsr(Tsr_In, mish_row);
+}
+
+Vector HardSwish_Vec_wCPU(Vector *Vec_In)
+{
+	return activation_Vec(Vec_In, hardswish_row);
+}
+
+Matrix HardSwish_Mat_wCPU(Matrix *Mat_In)
+{
+	return activation_Mat(Mat_In, hardswish_row);
+}
+
+Tensor HardSwish_Tsr_wCPU(Tensor *Tsr_In)
+{
+	return activation_Tsr(Tsr_In, hardswish_row);
+}
+
+Activation_LUT create_activation_lut(Activation_Type type, float slope, float in_scale, int in_zero_point, float out_scale, int out_zero_point)
+{
+	assert(in_scale > 0 && out_scale > 0);
+	assert(in_zero_point >= -128 && in_zero_point <= 127);
+	assert(out_zero_point >= -128 && out_zero_point <= 127);
+	
+	Activation_LUT lut;
+	
+	lut.in_scale = in_scale;
+	lut.in_zero_point = in_zero_point;
+	lut.out_scale = out_scale;
+	lut.out_zero_point = out_zero_point;
+	
+	// Dequantize every possible input code, run the float activation on all of them
+	// at once and requantize, so each entry equals the float result rounded
+	float x[256], y[256];
+	
+	for (int q = 0; q < 256; q++)
+	{
+		x[q] = in_scale*((q - 128) - in_zero_point);
+	}
+	
+	activation_type_row(x, y, 256, type, slope);
+	
+	for (int q = 0; q < 256; q++)
+	{
+		float r = roundf(y[q]/out_scale) + out_zero_point;
+		
+		r = (r > 127.0f) ? 127.0f : r;
+		r = (r < -128.0f) ? -128.0f : r;
+		
+		// NaN results (e.g. a NaN slope) map to the zero point
+		lut.table[q] = (r == r) ? (int8_t)r : (int8_t)out_zero_point;
+	}
+	
+	return lut;
+}
+
+void activation_lut_int8_wCPU(Activation_LUT *lut, const int8_t *in, int8_t *out, int len)
+{
+	const int8_t *table = lut->table;
+	
+	for (int j = 0; j < len; j++)
+	{
+		out[j] = table[in[j] + 128];
+	}
+}
@@ -26,7 +26,15 @@
  *
  * Activation functions define the output of a node given an input or set of inputs.\n
  * Usually activation functions are used to introduce non-linearity relationship
- * between input and output.
+ * between input and output.\n
+ * Exponential, sigmoid and tanh are evaluated in single precision by branch-free
+ * polynomial approximations that the compiler vectorizes. Maximum error measured
+ * against double precision on every third float is 1.0 ulp for exp, 1.33 ulp for tanh 
+ * (just above |x| = 0.625) and 2.4 ulp for sigmoid, including the denormal results of
+ * exp and sigmoid down to x = -103.9, below which they return 0. NaN propagates.
+ * Compiling with -DDEEPC_FAST_ACTIVATION trades accuracy for speed, with a maximum 
+ * relative error of about 4e-5 (~660 ulp).\n
+ * Activations on int8 quantized data are applied through 256-entry lookup tables.
  * 
  * @author Andriyanto Halim
  * @date 16 May 2018
@@ -50,12 +58,51 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <float.h>
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "vector.h"
 #include "matrix.h"
 #include "tensor.h"
 
+/**
+ * @brief	Element-wise activations applicable in place on raw rows
+ * 
+ * Used by activation_inplace_row_wCPU() so that other operations can apply the
+ * activation as a fused epilogue on each output row while it is still in cache.
+ */
+typedef enum Activation_Type
+{
+	ACTIVATION_IDENTITY = 0,	/**< no activation:					x */
+	ACTIVATION_RELU,			/**< rectified linear unit:			max(x, 0) */
+	ACTIVATION_RELU6,			/**< rectified linear unit capped:	min(max(x, 0), 6) */
+	ACTIVATION_LEAKY_RELU,		/**< leaky ReLU:					x > 0 ? x : slope*x */
+	ACTIVATION_SIGMOID,			/**< logistic sigmoid:				1/(1 + exp(-x)) */
+	ACTIVATION_TANH,			/**< hyperbolic tangent:			tanh(x) */
+	ACTIVATION_GELU,			/**< GELU, exact normal CDF:		x*Phi(x) */
+	ACTIVATION_GELU_TANH,		/**< GELU, tanh approximation:		x*(1 + tanh(sqrt(2/pi)*(x + 0.044715*x^3)))/2 */
+	ACTIVATION_SILU,			/**< SiLU (Swish):					x*sigmoid(x) */
+	ACTIVATION_MISH,			/**< Mish:							x*tanh(log(1 + exp(x))) */
+	ACTIVATION_HARDSWISH		/**< HardSwish:						x*min(max(x + 3, 0), 6)/6 */
+} Activation_Type;
+
+/**
+ * @brief	Lookup table of an activation on int8 quantized values
+ * 
+ * Quantized values follow real = scale*(q - zero_point) with q in [-128, 127].
+ * Since there are only 256 input codes, the activation is evaluated once per code
+ * and applied as a table lookup. Build one table per (type, input quantization,
+ * output quantization) and reuse it for every call of the layer.
+ */
+typedef struct Activation_LUT
+{
+	float in_scale, out_scale;
+	int in_zero_point, out_zero_point;
+	int8_t table[256];		/**< output code of input code q at table[q + 128] */
+} Activation_LUT;
+
 /**
  * @brief	ReLU for vector
  * @param 	Vec_In
@@ -95,33 +142,230 @@ Tensor ReLU_Tsr_wCPU(Tensor *Tsr_In);
  * @return 	Vector
  * 
  * Leaky ReLU activation function for vector.\n
- * This function applies Leaky ReLU function on each element of input vector
- * and return a new vector of the same dimension.
+ * This function applies Leaky ReLU function with a slope of 0.01 for negative inputs
+ * on each element of input vector and return a new vector of the same dimension.
+ * See Leaky_ReLU_slope_Vec_wCPU() for another slope.
  */
 Vector Leaky_ReLU_Vec_wCPU(Vector *Vec_In);
 
+/**
+ * @brief	Leaky ReLU with slope for vector
+ * @param 	Vec_In
+ * @param 	slope
+ * @return 	Vector
+ * 
+ * Leaky ReLU activation function for vector.\n
+ * This function applies Leaky ReLU function with the given slope for negative inputs
+ * on each element of input vector
+ * and return a new vector of the same dimension.
+ */
+Vector Leaky_ReLU_slope_Vec_wCPU(Vector *Vec_In, float slope);
+
 /**
  * @brief	Leaky ReLU for matrix
  * @param 	Mat_In
  * @return 	Matrix
  * 
  * Leaky ReLU activation function for matrix.\n
- * This function applies Leaky ReLU function on each input matrix element.
- * and return a new matrix of the same dimension.
+ * This function applies Leaky ReLU function with a slope of 0.01 for negative inputs
+ * on each input matrix element and return a new matrix of the same dimension.
+ * See Leaky_ReLU_slope_Mat_wCPU() for another slope.
  */
 Matrix Leaky_ReLU_Mat_wCPU(Matrix *Mat_In);
 
+/**
+ * @brief	Leaky ReLU with slope for matrix
+ * @param 	Mat_In
+ * @param 	slope
+ * @return 	Matrix
+ * 
+ * Leaky ReLU activation function for matrix.\n
+ * This function applies Leaky ReLU function with the given slope for negative inputs
+ * on each input matrix element
+ * and return a new matrix of the same dimension.
+ */
+Matrix Leaky_ReLU_slope_Mat_wCPU(Matrix *Mat_In, float slope);
+
 /**
  * @brief	Leaky ReLU for tensor
  * @param 	Tsr_In
  * @return 	Tensor
  * 
  * Leaky ReLU activation function for tensor.\n
- * This function applies Leaky ReLU function on each input tensor element.
- * and return a new tensor of the same dimension.
+ * This function applies Leaky ReLU function with a slope of 0.01 for negative inputs
+ * on each input tensor element and return a new tensor of the same dimension.
+ * See Leaky_ReLU_slope_Tsr_wCPU() for another slope.
  */
 Tensor Leaky_ReLU_Tsr_wCPU(Tensor *Tsr_In);
 
+/**
+ * @brief	Leaky ReLU with slope for tensor
+ * @param 	Tsr_In
+ * @param 	slope
+ * @return 	Tensor
+ * 
+ * Leaky ReLU activation function for tensor.\n
+ * This function applies Leaky ReLU function with the given slope for negative inputs
+ * on each input tensor element
+ * and return a new tensor of the same dimension.
+ */
+Tensor Leaky_ReLU_slope_Tsr_wCPU(Tensor *Tsr_In, float slope);
+
+/**
+ * @brief	ReLU6 for vector
+ * @param 	Vec_In
+ * @return 	Vector
+ * 
+ * This function applies min(max(x, 0), 6) on each element of input vector
+ * and return a new vector of the same dimension.
+ */
+Vector ReLU6_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	ReLU6 for matrix
+ * @param 	Mat_In
+ * @return 	Matrix
+ * 
+ * This function applies min(max(x, 0), 6) on each element of input matrix
+ * and return a new matrix of the same dimension.
+ */
+Matrix ReLU6_Mat_wCPU(Matrix *Mat_In);
+
+/**
+ * @brief	ReLU6 for tensor
+ * @param 	Tsr_In
+ * @return 	Tensor
+ * 
+ * This function applies min(max(x, 0), 6) on each element of input tensor
+ * and return a new tensor of the same dimension.
+ */
+Tensor ReLU6_Tsr_wCPU(Tensor *Tsr_In);
+
+/**
+ * @brief	In-place ReLU for vector
+ * @param 	Vec
+ * @return 	None
+ * 
+ * This function applies ReLU function on each element of the vector in place.
+ */
+void ReLU_inplace_Vec_wCPU(Vector *Vec);
+
+/**
+ * @brief	In-place ReLU for matrix
+ * @param 	Mat
+ * @return 	None
+ * 
+ * This function applies ReLU function on each element of the matrix in place.
+ */
+void ReLU_inplace_Mat_wCPU(Matrix *Mat);
+
+/**
+ * @brief	In-place ReLU for tensor
+ * @param 	Tsr
+ * @return 	None
+ * 
+ * This function applies ReLU function on each element of the tensor in place.
+ */
+void ReLU_inplace_Tsr_wCPU(Tensor *Tsr);
+
+/**
+ * @brief	In-place ReLU6 for vector
+ * @param 	Vec
+ * @return 	None
+ * 
+ * This function applies min(max(x, 0), 6) on each element of the vector in place.
+ */
+void ReLU6_inplace_Vec_wCPU(Vector *Vec);
+
+/**
+ * @brief	In-place ReLU6 for matrix
+ * @param 	Mat
+ * @return 	None
+ * 
+ * This function applies min(max(x, 0), 6) on each element of the matrix in place.
+ */
+void ReLU6_inplace_Mat_wCPU(Matrix *Mat);
+
+/**
+ * @brief	In-place ReLU6 for tensor
+ * @param 	Tsr
+ * @return 	None
+ * 
+ * This function applies min(max(x, 0), 6) on each element of the tensor in place.
+ */
+void ReLU6_inplace_Tsr_wCPU(Tensor *Tsr);
+
+/**
+ * @brief	In-place Leaky ReLU for vector
+ * @param 	Vec
+ * @param 	slope
+ * @return 	None
+ * 
+ * This function applies Leaky ReLU function with the given slope for negative
+ * inputs on each element of the vector in place.
+ */
+void Leaky_ReLU_inplace_Vec_wCPU(Vector *Vec, float slope);
+
+/**
+ * @brief	In-place Leaky ReLU for matrix
+ * @param 	Mat
+ * @param 	slope
+ * @return 	None
+ * 
+ * This function applies Leaky ReLU function with the given slope for negative
+ * inputs on each element of the matrix in place.
+ */
+void Leaky_ReLU_inplace_Mat_wCPU(Matrix *Mat, float slope);
+
+/**
+ * @brief	In-place Leaky ReLU for tensor
+ * @param 	Tsr
+ * @param 	slope
+ * @return 	None
+ * 
+ * This function applies Leaky ReLU function with the given slope for negative
+ * inputs on each element of the tensor in place.
+ */
+void Leaky_ReLU_inplace_Tsr_wCPU(Tensor *Tsr, float slope);
+
+/**
+ * @brief	Parametric ReLU for tensor
+ * @param 	Tsr_In
+ * @param 	Vec_Slopes
+ * @return 	Tensor
+ * 
+ * This function applies Leaky ReLU function on each layer of the input tensor with
+ * the slope of that layer (channel), Vec_Slopes->len == depth, and return a new
+ * tensor of the same dimension.
+ */
+Tensor PReLU_Tsr_wCPU(Tensor *Tsr_In, Vector *Vec_Slopes);
+
+/**
+ * @brief	In-place parametric ReLU for tensor
+ * @param 	Tsr
+ * @param 	Vec_Slopes
+ * @return 	None
+ * 
+ * This function applies Leaky ReLU function on each layer of the tensor in place
+ * with the slope of that layer (channel), Vec_Slopes->len == depth.
+ */
+void PReLU_inplace_Tsr_wCPU(Tensor *Tsr, Vector *Vec_Slopes);
+
+/**
+ * @brief	In-place activation on a raw row
+ * @param 	vals
+ * @param 	len
+ * @param 	type
+ * @param 	slope
+ * @return 	None
+ * @note	slope is only used by ACTIVATION_LEAKY_RELU
+ * 
+ * This function applies the activation on len contiguous floats in place, without
+ * branches per element. It is meant to be called by other operations as a fused
+ * epilogue on each output row right after it is produced.
+ */
+void activation_inplace_row_wCPU(float *vals, int len, Activation_Type type, float slope);
+
 /**
  * @brief	Softmax for vector
  * @param 	Vec_In
@@ -129,7 +373,8 @@ Tensor Leaky_ReLU_Tsr_wCPU(Tensor *Tsr_In);
  * 
  * Softmax activation function for vector.\n
  * This function applies softmax function on each element of input vector
- * and return a new vector of the same dimension.
+ * and return a new vector of the same dimension. The maximum is subtracted
+ * before exponentiation, so large inputs do not overflow.
  */
 Vector softmax_Vec_wCPU(Vector *Vec_In);
 
@@ -141,6 +386,8 @@ Vector softmax_Vec_wCPU(Vector *Vec_In);
  * Softmax activation function for matrix.\n
  * This function applies softmax function on each element of input matrix
  * and return a new matrix of the same dimension.
+ * @note	All elements are normalized together, use softmax_axis_Mat_wCPU()
+ * 			for a softmax per row or per column.
  */
 Matrix softmax_Mat_wCPU(Matrix *Mat_In);
 
@@ -149,12 +396,73 @@ Matrix softmax_Mat_wCPU(Matrix *Mat_In);
  * @param 	Tsr_In
  * @return 	Tensor
  * 
- * Softmax activation function for vector.\n
- * This function applies softmax function on each element of input vector
+ * Softmax activation function for tensor.\n
+ * This function applies softmax function on each element of input tensor
  * and return a new tensor of the same dimension.
+ * @note	All elements are normalized together, use softmax_axis_Tsr_wCPU()
+ * 			for a softmax along one axis.
  */
 Tensor softmax_Tsr_wCPU(Tensor *Tsr_In);
 
+/**
+ * @brief	Log-softmax for vector
+ * @param 	Vec_In
+ * @return 	Vector
+ * 
+ * This function computes log(softmax(x)) of the input vector as x - max - log(sum(exp(x - max)))
+ * and return a new vector of the same dimension.
+ */
+Vector log_softmax_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	Softmax along an axis of matrix
+ * @param 	Mat_In
+ * @param 	axis
+ * @return 	Matrix
+ * 
+ * This function applies softmax along the given axis of the input matrix: axis 1
+ * normalizes each row, axis 0 normalizes each column. Return a new matrix of the same dimension.\n
+ * Maximum and sum of exponentials are found in one pass over the input
+ * (online normalizer), and the output is written in a second pass without any
+ * intermediate buffer. Rows (or column blocks) are processed in parallel.
+ */
+Matrix softmax_axis_Mat_wCPU(Matrix *Mat_In, int axis);
+
+/**
+ * @brief	Log-softmax along an axis of matrix
+ * @param 	Mat_In
+ * @param 	axis
+ * @return 	Matrix
+ * 
+ * This function applies log-softmax along the given axis of the input matrix,
+ * see softmax_axis_Mat_wCPU(), and return a new matrix of the same dimension.
+ */
+Matrix log_softmax_axis_Mat_wCPU(Matrix *Mat_In, int axis);
+
+/**
+ * @brief	Softmax along an axis of tensor
+ * @param 	Tsr_In
+ * @param 	axis
+ * @return 	Tensor
+ * 
+ * This function applies softmax along the given axis of the input tensor and
+ * return a new tensor of the same dimension. Axis 0 normalizes across the layers at
+ * each position (per-pixel channel softmax), axis 1 down the rows and axis 2 along
+ * the columns of each layer.
+ */
+Tensor softmax_axis_Tsr_wCPU(Tensor *Tsr_In, int axis);
+
+/**
+ * @brief	Log-softmax along an axis of tensor
+ * @param 	Tsr_In
+ * @param 	axis
+ * @return 	Tensor
+ * 
+ * This function applies log-softmax along the given axis of the input tensor,
+ * see softmax_axis_Tsr_wCPU(), and return a new tensor of the same dimension.
+ */
+Tensor log_softmax_axis_Tsr_wCPU(Tensor *Tsr_In, int axis);
+
 /**
  * @brief	Tanh for vector
  * @param 	Vec_In
@@ -162,7 +470,8 @@ Tensor softmax_Tsr_wCPU(Tensor *Tsr_In);
  * 
  * Hyperbolic tangent activation function for vector.\n
  * This function applies tanh function on each element of input vector 
- * and return a new vector of the same dimension.
+ * and return a new vector of the same dimension.\n
+ * Maximum error is about 1.33 ulp (see DEEPC_FAST_ACTIVATION for the fast mode).
  */
 Vector tanh_Vec_wCPU(Vector *Vec_In);
 
@@ -194,7 +503,9 @@ Tensor tanh_Tsr_wCPU(Tensor *Tsr_In);
  * @return 	Vector
  * 
  * This function applies sigmoid function on each element of the input vector
- * and return a new vector of the same dimension.
+ * and return a new vector of the same dimension.\n
+ * Maximum error is about 2.4 ulp, results for x below -87.3 are denormal and
+ * reach 0 below -103.9 (see DEEPC_FAST_ACTIVATION for the fast mode).
  */
 Vector sigmoid_Vec_wCPU(Vector *Vec_In);
 
@@ -220,4 +531,263 @@ Matrix sigmoid_Mat_wCPU(Matrix *Mat_In);
  */
 Tensor sigmoid_Tsr_wCPU(Tensor *Tsr_In);
 
+/**
+ * @brief	Exponential for vector
+ * @param 	Vec_In
+ * @return 	Vector
+ * 
+ * This function applies the exponential function on each element of the input vector
+ * and return a new vector of the same dimension.\n
+ * Maximum error is 1 ulp for results in the normal float range; larger inputs
+ * overflow to inf and smaller ones underflow to zero.
+ */
+Vector exp_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	Exponential for matrix
+ * @param 	Mat_In
+ * @return 	Matrix
+ * 
+ * This function applies the exponential function on each element of the input matrix
+ * and return a new matrix of the same dimension.
+ */
+Matrix exp_Mat_wCPU(Matrix *Mat_In);
+
+/**
+ * @brief	Exponential for tensor
+ * @param 	Tsr_In
+ * @return 	Tensor
+ * 
+ * This function applies the exponential function on each element of the input tensor
+ * and return a new tensor of the same dimension.
+ */
+Tensor exp_Tsr_wCPU(Tensor *Tsr_In);
+
+/**
+ * @brief	GELU for vector
+ * @param 	Vec_In
+ * @return 	Vector
+ * 
+ * This function applies x*Phi(x), with Phi the standard normal CDF evaluated through erfc,
+ * on each element of the input vector and return a new vector of the same dimension.\n
+ * Relative error of the result is below 5e-7 for x >= -1, 2.4e-6 for x >= -5 and 2e-5
+ * down to x = -13; it grows with x^2 as the rounding of the exp argument -x^2/2 does.
+ * Beyond that the result is denormal, -inf gives -0.
+ */
+Vector GELU_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	GELU for matrix
+ * @param 	Mat_In
+ * @return 	Matrix
+ * 
+ * This function applies x*Phi(x), with Phi the standard normal CDF evaluated through erfc,
+ * on each element of the input matrix and return a new matrix of the same dimension.\n
+ * Accuracy is the same as GELU_Vec_wCPU(): relative error below 5e-7 for x >= -1,
+ * 2.4e-6 for x >= -5 and 2e-5 down to x = -13.
+ */
+Matrix GELU_Mat_wCPU(Matrix *Mat_In);
+
+/**
+ * @brief	GELU for tensor
+ * @param 	Tsr_In
+ * @return 	Tensor
+ * 
+ * This function applies x*Phi(x), with Phi the standard normal CDF evaluated through erfc,
+ * on each element of the input tensor and return a new tensor of the same dimension.\n
+ * Accuracy is the same as GELU_Vec_wCPU(): relative error below 5e-7 for x >= -1,
+ * 2.4e-6 for x >= -5 and 2e-5 down to x = -13.
+ */
+Tensor GELU_Tsr_wCPU(Tensor *Tsr_In);
+
+/**
+ * @brief	GELU (tanh approximation) for vector
+ * @param 	Vec_In
+ * @return 	Vector
+ * 
+ * This function applies x*(1 + tanh(sqrt(2/pi)*(x + 0.044715*x^3)))/2 on each element of the input vector
+ * and return a new vector of the same dimension.
+ */
+Vector GELU_tanh_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	GELU (tanh approximation) for matrix
+ * @param 	Mat_In
+ * @return 	Matrix
+ * 
+ * This function applies x*(1 + tanh(sqrt(2/pi)*(x + 0.044715*x^3)))/2 on each element of the input matrix
+ * and return a new matrix of the same dimension.
+ */
+Matrix GELU_tanh_Mat_wCPU(Matrix *Mat_In);
+
+/**
+ * @brief	GELU (tanh approximation) for tensor
+ * @param 	Tsr_In
+ * @return 	Tensor
+ * 
+ * This function applies x*(1 + tanh(sqrt(2/pi)*(x + 0.044715*x^3)))/2 on each element of the input tensor
+ * and return a new tensor of the same dimension.
+ */
+Tensor GELU_tanh_Tsr_wCPU(Tensor *Tsr_In);
+
+/**
+ * @brief	SiLU for vector
+ * @param 	Vec_In
+ * @return 	Vector
+ * 
+ * This function applies x*sigmoid(x) (Swish with beta = 1) on each element of the input vector
+ * and return a new vector of the same dimension. -inf gives -0.
+ */
+Vector SiLU_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	SiLU for matrix
+ * @param 	Mat_In
+ * @return 	Matrix
+ * 
+ * This function applies x*sigmoid(x) (Swish with beta = 1) on each element of the input matrix
+ * and return a new matrix of the same dimension.
+ */
+Matrix SiLU_Mat_wCPU(Matrix *Mat_In);
+
+/**
+ * @brief	SiLU for tensor
+ * @param 	Tsr_In
+ * @return 	Tensor
+ * 
+ * This function applies x*sigmoid(x) (Swish with beta = 1) on each element of the input tensor
+ * and return a new tensor of the same dimension.
+ */
+Tensor SiLU_Tsr_wCPU(Tensor *Tsr_In);
+
+/**
+ * @brief	Mish for vector
+ * @param 	Vec_In
+ * @return 	Vector
+ * 
+ * This function applies x*tanh(softplus(x)) on each element of the input vector
+ * and return a new vector of the same dimension. -inf gives -0.
+ */
+Vector Mish_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	Mish for matrix
+ * @param 	Mat_In
+ * @return 	Matrix
+ * 
+ * This function applies x*tanh(softplus(x)) on each element of the input matrix
+ * and return a new matrix of the same dimension.
+ */
+Matrix Mish_Mat_wCPU(Matrix *Mat_In);
+
+/**
+ * @brief	Mish for tensor
+ * @param 	Tsr_In
+ * @return 	Tensor
+ * 
+ * This function applies x*tanh(softplus(x)) on each element of the input tensor
+ * and return a new tensor of the same dimension.
+ */
+Tensor Mish_Tsr_wCPU(Tensor *Tsr_In);
+
+/**
+ * @brief	HardSwish for vector
+ * @param 	Vec_In
+ * @return 	Vector
+ * 
+ * This function applies x*min(max(x + 3, 0), 6)/6 on each element of the input vector
+ * and return a new vector of the same dimension.
+ */
+Vector HardSwish_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	HardSwish for matrix
+ * @param 	Mat_In
+ * @return 	Matrix
+ * 
+ * This function applies x*min(max(x + 3, 0), 6)/6 on each element of the input matrix
+ * and return a new matrix of the same dimension.
+ */
+Matrix HardSwish_Mat_wCPU(Matrix *Mat_In);
+
+/**
+ * @brief	HardSwish for tensor
+ * @param 	Tsr_In
+ * @return 	Tensor
+ * 
+ * This function applies x*min(max(x + 3, 0), 6)/6 on each element of the input tensor
+ * and return a new tensor of the same dimension.
+ */
+Tensor HardSwish_Tsr_wCPU(Tensor *Tsr_In);
+
+/**
+ * @brief	In-place activation for vector
+ * @param 	Vec
+ * @param 	type
+ * @param 	slope
+ * @return 	None
+ * @note	slope is only used by ACTIVATION_LEAKY_RELU
+ * 
+ * This function applies the activation on each element of the vector in place.
+ */
+void activation_inplace_Vec_wCPU(Vector *Vec, Activation_Type type, float slope);
+
+/**
+ * @brief	In-place activation for matrix
+ * @param 	Mat
+ * @param 	type
+ * @param 	slope
+ * @return 	None
+ * @note	slope is only used by ACTIVATION_LEAKY_RELU
+ * 
+ * This function applies the activation on each element of the matrix in place.
+ */
+void activation_inplace_Mat_wCPU(Matrix *Mat, Activation_Type type, float slope);
+
+/**
+ * @brief	In-place activation for tensor
+ * @param 	Tsr
+ * @param 	type
+ * @param 	slope
+ * @return 	None
+ * @note	slope is only used by ACTIVATION_LEAKY_RELU
+ * 
+ * This function applies the activation on each element of the tensor in place.
+ */
+void activation_inplace_Tsr_wCPU(Tensor *Tsr, Activation_Type type, float slope);
+
+/**
+ * @brief	Create lookup table for int8 activation
+ * @param 	type
+ * @param 	slope
+ * @param 	in_scale
+ * @param 	in_zero_point
+ * @param 	out_scale
+ * @param 	out_zero_point
+ * @return 	Activation_LUT
+ * @note	
+ * 1. slope is only used by ACTIVATION_LEAKY_RELU
+ * 2. in_zero_point and out_zero_point must be in [-128, 127]
+ * 
+ * This function evaluates the float activation on all 256 dequantized input codes and
+ * stores the results requantized (rounded to nearest and saturated to [-128, 127]).
+ * Applying the table is therefore exact with respect to the float activation.
+ */
+Activation_LUT create_activation_lut(Activation_Type type, float slope, float in_scale, int in_zero_point, float out_scale, int out_zero_point);
+
+/**
+ * @brief	Apply int8 activation by table lookup
+ * @param 	lut
+ * @param 	in
+ * @param 	out
+ * @param 	len
+ * @return 	None
+ * 
+ * This function maps len int8 codes of in through the lookup table into out.
+ * in and out may be the same buffer for an in-place activation.\n
+ * The lookup is a scalar indexed load per element from the L1-resident table,
+ * not a vectorized shuffle or gather.
+ */
+void activation_lut_int8_wCPU(Activation_LUT *lut, const int8_t *in, int8_t *out, int len);
+
 #endif /* ACTIVATION_H  */
@@ -43,6 +43,7 @@
  */
  
 #include "blas.h"
+#include "internal.h"
 
 Vector scale_Vec_wCPU(Vector *Vec_In, float scaling_factor)
 {
@@ -185,55 +186,91 @@ Tensor addition_Tsr_wCPU(Tensor *Tsr_A, Tensor *Tsr_B)
     return tempTsr;
 }
 
-float dotproduct_Vec_wCPU(Vector *Vec_A, Vector *Vec_B)
+// Dot product of one part in REDUCE_LANES lanes, parts are merged by reduce_tree()
+static double dotproduct_chunk(const float *vals_A, const float *vals_B, int len)
 {
-	assert(Vec_A->len == Vec_B->len);
+	float lanesum[REDUCE_LANES] = {0};
+	int steps = len / REDUCE_LANES;
+	
+	for (int t = 0; t < steps; t++)
+	{
+		for (int l = 0; l < REDUCE_LANES; l++)
+		{
+			lanesum[l] += vals_A[t * REDUCE_LANES + l] * vals_B[t * REDUCE_LANES + l];
+		}
+	}
 	
-	float tempsum = 0;
+	double tempsum = 0;
 	
-	for(int i = 0; i < Vec_A->len ; i++)
+	for (int l = 0; l < REDUCE_LANES; l++)
 	{
-		tempsum += Vec_A->vals[i] * Vec_B->vals[i];
+		tempsum += lanesum[l];
 	}
 	
-	return tempsum;	
+	for (int j = steps * REDUCE_LANES; j < len; j++)
+	{
+		tempsum += (double)vals_A[j] * vals_B[j];
+	}
+	
+	return tempsum;
+}
+
+static void dotproduct_part(const void *ctx, long part, void *partial)
+{
+	const Reduce_Source *Src = ctx;
+	int len;
+	const float *vals_A = reduce_part(&Src[0], part, &len);
+	const float *vals_B = reduce_part(&Src[1], part, &len);
+	
+	*(double *)partial = dotproduct_chunk(vals_A, vals_B, len);
+}
+
+static void dotproduct_merge(void *partial, const void *other)
+{
+	*(double *)partial += *(const double *)other;
+}
+
+// Both sources have the same shape and layout, they are released
+static float dotproduct_source(Reduce_Source *Src)
+{
+	double tempsum = 0;
+	
+	reduce_tree(reduce_parts(&Src[0]), sizeof(double), dotproduct_part, dotproduct_merge, Src, &tempsum);
+	free_reduce_source(&Src[0]);
+	free_reduce_source(&Src[1]);
+	
+	return (float)tempsum;
+}
+
+float dotproduct_Vec_wCPU(Vector *Vec_A, Vector *Vec_B)
+{
+	assert(Vec_A->len == Vec_B->len);
+	
+	Reduce_Source tempSrc[2] = {reduce_source_Vec(Vec_A), reduce_source_Vec(Vec_B)};
+	
+	return dotproduct_source(tempSrc);
 }
 
 float dotproduct_Mat_wCPU(Matrix *Mat_A, Matrix *Mat_B)
 {
-    assert(Mat_A->row == Mat_B->row && Mat_B->col == Mat_B->col);
-    
-    float tempsum = 0;
-    
-    for(int i = 0; i < Mat_A->row ; i++)
-    {
-        for(int j = 0; j < Mat_A->col ; j++)
-        {
-            tempsum += Mat_A->vals[i][j] * Mat_B->vals[i][j];
-        }
-    }
-    
-    return tempsum;   
+	assert(Mat_A->row == Mat_B->row && Mat_A->col == Mat_B->col);
+	
+	// Contiguous blocks only if both have one, rows otherwise
+	int flat = is_contiguous_Mat(Mat_A) && is_contiguous_Mat(Mat_B);
+	Reduce_Source tempSrc[2] = {reduce_source_Mat(Mat_A, flat), reduce_source_Mat(Mat_B, flat)};
+	
+	return dotproduct_source(tempSrc);
 }
 
 float dotproduct_Tsr_wCPU(Tensor *Tsr_A, Tensor *Tsr_B)
 {
-    assert(Tsr_A->row == Tsr_B->row && Tsr_B->col == Tsr_B->col && Tsr_A->depth == Tsr_B->depth);
-    
-    float tempsum = 0;
-    
-    for(int k = 0; k < Tsr_A->depth; k++)
-    {
-		for(int i = 0; i < Tsr_A->row ; i++)
-		{
-			for(int j = 0; j < Tsr_A->col ; j++)
-			{
-				tempsum += Tsr_A->vals[k][i][j] * Tsr_B->vals[k][i][j];
-			}
-		}
-	}
-    
-    return tempsum;   
+	assert(Tsr_A->row == Tsr_B->row && Tsr_A->col == Tsr_B->col && Tsr_A->depth == Tsr_B->depth);
+	
+	// Contiguous blocks only if both have one, rows otherwise
+	int flat = is_contiguous_Tsr(Tsr_A) && is_contiguous_Tsr(Tsr_B);
+	Reduce_Source tempSrc[2] = {reduce_source_Tsr(Tsr_A, flat), reduce_source_Tsr(Tsr_B, flat)};
+	
+	return dotproduct_source(tempSrc);
 }
 
 Matrix multiplication_Vec_wCPU(Vector *Vec_A, Vector *Vec_B)
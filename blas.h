@@ -162,9 +162,8 @@ Tensor addition_Tsr_wCPU(Tensor *Tsr_A, Tensor *Tsr_B);
  * @param	Vec_B
  * @return 	float
  * @note 	Vectors dimension must be the same
- * @todo	
- * 1. To explore Kahan summation algorithm https://en.wikipedia.org/wiki/Kahan_summation_algorithm
- * 2. To explore parallelism (OpenMP, CUDA, AVX/AVX2, NEON)
+ * @note	The sum is reduced in parallel over fixed chunks and the partials are merged in a
+ * fixed order, so the result does not depend on the number of OpenMP threads
  * 
  * This function perform dot product on two vectors, i.e. element-wise 
  * multiplication and return a new vector of the same dimension.
@@ -176,10 +175,8 @@ float dotproduct_Vec_wCPU(Vector *Vec_A, Vector *Vec_B);
  * @param 	Mat_A
  * @param	Mat_B
  * @return 	float
- * @note 	Matrices dimension must be the same
- * @todo	
- * 1. To explore Kahan summation algorithm https://en.wikipedia.org/wiki/Kahan_summation_algorithm
- * 2. To explore parallelism (OpenMP, CUDA, AVX/AVX2, NEON)
+ * @note 	Matrices dimension must be the same. The result does not depend on the number
+ * of OpenMP threads, see dotproduct_Vec_wCPU()
  * 
  * This function perform dot product on two matrices, i.e. element-wise 
  * multiplication and return a new vector of the same dimension.
@@ -191,10 +188,8 @@ float dotproduct_Mat_wCPU(Matrix *Mat_A, Matrix *Mat_B);
  * @param 	Tsr_A
  * @param	Tsr_B
  * @return 	float
- * @note 	Tensors dimension must be the same
- * @todo	
- * 1. To explore Kahan summation algorithm https://en.wikipedia.org/wiki/Kahan_summation_algorithm
- * 2. To explore parallelism (OpenMP, CUDA, AVX/AVX2, NEON)
+ * @note 	Tensors dimension must be the same. The result does not depend on the number
+ * of OpenMP threads, see dotproduct_Vec_wCPU()
  * 
  * This function perform dot product on two tensors, i.e. element-wise 
  * multiplication and return a new tensor of the same dimension.
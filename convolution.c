@@ -48,67 +48,67 @@
  
 #include "convolution.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Accumulate one output row of a 2D convolution between one input layer and one kernel layer.
+// Loops are ordered per kernel tap, so the innermost loop is a contiguous multiply-add over 
+// the output row (vectorized by the compiler) when stride is 1.
+// i is the top input row of the receptive field, taps are spaced dilation elements apart.
+static void convolution_2d_row_accumulate(float *outrow, int tempcol, float **invals, int i, 
+										  float **kernelvals, int kernelrow, int kernelcol, 
+										  int stride, int dilation)
+{
+	for (int m = 0; m < kernelrow; m++)
+	{
+		float *inrow = invals[i + m*dilation];
+		
+		for (int n = 0; n < kernelcol; n++)
+		{
+			float weight = kernelvals[m][n];
+			float *src = inrow + n*dilation;
+			
+			if (stride == 1)
+			{
+				for (int q = 0; q < tempcol; q++)
+				{
+					outrow[q] += weight * src[q];
+				}
+			}
+			else
+			{
+				for (int q = 0; q < tempcol; q++)
+				{
+					outrow[q] += weight * src[q*stride];
+				}
+			}
+		}
+	}
+}
+
 Matrix convolution_2d_Mat_wCPU(Matrix *Mat_In, Matrix *Mat_kernel, int stride)
 {
     assert(stride > 0);
     
-    // Calculate output matrix size
-    int temprow = (Mat_In->row - Mat_kernel->row)/stride + 1;
-    int tempcol = (Mat_In->col - Mat_kernel->col)/stride + 1;
-    
-    // Calculate row- and col- boundaries for convolution to avoid rogue pointing 
-    int rowbound = Mat_In->row - Mat_kernel->row + 1;
-    int colbound = Mat_In->col - Mat_kernel->col + 1;
-    
-    // Create output matrix
-    Matrix tempMat = create_matrix(temprow, tempcol);
-    
-    // p and q are the row- and col- indices for output matrix
-	int p = 0;
-	
-    for(int i = 0; i < rowbound; i+= stride)
-    {
-        int q = 0; 
-        
-        for(int j = 0; j < colbound; j+= stride)
-        {
-            // Initialize a variable tempsum to store the summation of multiplication
-            float tempsum = 0.0f;
-            
-            for(int m = 0; m < Mat_kernel->row; m++)
-            {
-                for(int n = 0; n < Mat_kernel->col; n++)
-                {
-                    tempsum += Mat_In->vals[i+m][j+n] * Mat_kernel->vals[m][n];
-                }
-            }
-            
-            // Assign tempsum to the respective output matrix component
-            tempMat.vals[p][q] = tempsum;
- 
-            q++;
-        }
-        
-        p++;
-    }
-    
-    return tempMat;
+    // Dense convolution is dilated convolution with adjacent kernel taps
+    return convolution_2d_dilated_Mat_wCPU(Mat_In, Mat_kernel, stride, 1);
 }
 
 Matrix convolution_2d_with_pad_Mat_wCPU(Matrix *Mat_In, int padsize, Matrix *Mat_kernel, int stride)
 {
 	assert(stride > 0);
 	
-	// Perform padding_2d
-	vpadding_2d_Mat_wCPU(Mat_In, padsize);
+	// Pad into a temporary, the caller's input is left untouched
+	Matrix tempIn = padding_2d_Mat_wCPU(Mat_In, padsize);
 	
 	// Calculate output matrix size
-	int temprow = (Mat_In->row - Mat_kernel->row)/stride + 1;
-    int tempcol = (Mat_In->col - Mat_kernel->col)/stride + 1;
+	int temprow = (tempIn.row - Mat_kernel->row)/stride + 1;
+    int tempcol = (tempIn.col - Mat_kernel->col)/stride + 1;
     
     // Calculate row- and col- boundaries for convolution to avoid rogue pointing
-    int rowbound = Mat_In->row - Mat_kernel->row + 1;
-    int colbound = Mat_In->col - Mat_kernel->col + 1;
+    int rowbound = tempIn.row - Mat_kernel->row + 1;
+    int colbound = tempIn.col - Mat_kernel->col + 1;
       
     // Create output matrix  
     Matrix tempMat = create_matrix(temprow, tempcol);
@@ -128,7 +128,7 @@ Matrix convolution_2d_with_pad_Mat_wCPU(Matrix *Mat_In, int padsize, Matrix *Mat
 			{
                 for(int n = 0; n < Mat_kernel->col; n++)
                 {
-                    tempsum += Mat_In->vals[i+m][j+n] * Mat_kernel->vals[m][n];    
+                    tempsum += tempIn.vals[i+m][j+n] * Mat_kernel->vals[m][n];    
                 }
             }
             
@@ -141,6 +141,8 @@ Matrix convolution_2d_with_pad_Mat_wCPU(Matrix *Mat_In, int padsize, Matrix *Mat
         p++;
     }
     
+    free_matrix(&tempIn);
+    
     return tempMat;
 }
 
@@ -149,54 +151,36 @@ Tensor convolution_2d_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernel, int stride, i
 	assert(stride > 0);
 	assert(Tsr_In->depth == Tsr_kernel->depth);
 	
-	// Calculate output matrix size
-    int temprow = (Tsr_In->row - Tsr_kernel->row)/stride + 1;
-    int tempcol = (Tsr_In->col - Tsr_kernel->col)/stride + 1;
-    
-    // Calculate row- and col- boundaries for convolution to avoid rogue pointing 
-    int rowbound = Tsr_In->row - Tsr_kernel->row + 1;
-    int colbound = Tsr_In->col - Tsr_kernel->col + 1;
-    
-    // Create output tensor
-    Tensor tempTsr = create_tensor(temprow, tempcol, filter_size);
-    
-    for(int k = 0; k < tempTsr.depth; k++)
-    {	
-		// p and q are the row- and col- indices for output matrix
-		int p = 0;
-	
-		for(int i = 0; i < rowbound; i+= stride)
+	// 1x1 kernel is a matrix multiplication over channels
+	if (Tsr_kernel->row == 1 && Tsr_kernel->col == 1)
+	{
+		// All filters share the same kernel, so compute one layer and replicate it
+		Matrix tempWeights = create_matrix(1, Tsr_kernel->depth);
+		
+		for (int o = 0; o < Tsr_kernel->depth; o++)
 		{
-			int q = 0; 
-			
-			for(int j = 0; j < colbound; j+= stride)
+			tempWeights.vals[0][o] = Tsr_kernel->vals[o][0][0];
+		}
+		
+		Tensor tempLayer = convolution_2d_pointwise_Tsr_wCPU(Tsr_In, &tempWeights, stride);
+		Tensor tempTsr = create_tensor(tempLayer.row, tempLayer.col, filter_size);
+		
+		for (int k = 0; k < filter_size; k++)
+		{
+			for (int i = 0; i < tempTsr.row; i++)
 			{
-				// Initialize a variable tempsum to store the summation of multiplication
-				float tempsum = 0.0f;
-				
-				for (int o = 0; o < Tsr_kernel->depth; o++)
-				// same effect: for(int o = 0; o < Tsr_In->depth; o++)
-				{
-					for(int m = 0; m < Tsr_kernel->row; m++)
-					{
-						for(int n = 0; n < Tsr_kernel->col; n++)
-						{
-							tempsum += Tsr_In->vals[o][i+m][j+n] * Tsr_kernel->vals[o][m][n];
-						}
-					}		
-				}
-				
-				// Assign tempsum to the respective output matrix component
-				tempTsr.vals[k][p][q] = tempsum;
-
-				q++;
+				memcpy(tempTsr.vals[k][i], tempLayer.vals[0][i], tempTsr.col * sizeof(float));
 			}
-			
-			p++;
-		}	
+		}
+		
+		free_matrix(&tempWeights);
+		free_tensor(&tempLayer);
+		
+		return tempTsr;
 	}
-    
-    return tempTsr;
+	
+	// Dense convolution is dilated convolution with adjacent kernel taps
+	return convolution_2d_dilated_Tsr_wCPU(Tsr_In, Tsr_kernel, stride, 1, filter_size);
 }
 
 Tensor convolution_2d_with_pad_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr_kernel, int stride, int filter_size)
@@ -204,16 +188,16 @@ Tensor convolution_2d_with_pad_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr
 	assert(stride > 0);
 	assert(Tsr_In->depth == Tsr_kernel->depth);
 
-	// Perform padding_2d
-	vpadding_2d_Tsr_wCPU(Tsr_In, padsize);
+	// Pad into a temporary, the caller's input is left untouched
+	Tensor tempIn = padding_2d_Tsr_wCPU(Tsr_In, padsize);
 	
 	// Calculate output matrix size
-	int temprow = (Tsr_In->row - Tsr_kernel->row)/stride + 1;
-    int tempcol = (Tsr_In->col - Tsr_kernel->col)/stride + 1;
+	int temprow = (tempIn.row - Tsr_kernel->row)/stride + 1;
+    int tempcol = (tempIn.col - Tsr_kernel->col)/stride + 1;
     
     // Calculate row- and col- boundaries for convolution to avoid rogue pointing
-    int rowbound = Tsr_In->row - Tsr_kernel->row + 1;
-    int colbound = Tsr_In->col - Tsr_kernel->col + 1;
+    int rowbound = tempIn.row - Tsr_kernel->row + 1;
+    int colbound = tempIn.col - Tsr_kernel->col + 1;
     
     // Create output tensor  
     Tensor tempTsr = create_tensor(temprow, tempcol, filter_size);
@@ -238,7 +222,7 @@ Tensor convolution_2d_with_pad_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr
 					{
 						for(int n = 0; n < Tsr_kernel->col; n++)
 						{
-							tempsum += Tsr_In->vals[o][i+m][j+n] * Tsr_kernel->vals[o][m][n];    
+							tempsum += tempIn.vals[o][i+m][j+n] * Tsr_kernel->vals[o][m][n];    
 						}
 					}
 				}
@@ -253,5 +237,1164 @@ Tensor convolution_2d_with_pad_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr
 		}
 	}		
 
+    free_tensor(&tempIn);
+    
     return tempTsr;
 }
+
+Tensor convolution_2d_pointwise_Tsr_wCPU(Tensor *Tsr_In, Matrix *Mat_Weights, int stride)
+{
+	assert(stride > 0);
+	assert(Mat_Weights->col == Tsr_In->depth);
+	assert(Tsr_In->row > 0 && Tsr_In->col > 0);
+	
+	// Calculate output tensor size, 1x1 kernel fits at every strided position
+	int temprow = (Tsr_In->row - 1)/stride + 1;
+	int tempcol = (Tsr_In->col - 1)/stride + 1;
+	
+	// Create output tensor, each weight matrix row is one filter
+	Tensor tempTsr = create_tensor(temprow, tempcol, Mat_Weights->row);
+	
+	// Each output row p only needs input row p*stride of every channel, which stays in 
+	// cache while all filters accumulate on it
+	#pragma omp parallel for
+	for (int p = 0; p < temprow; p++)
+	{
+		for (int k = 0; k < Mat_Weights->row; k++)
+		{
+			float *outrow = tempTsr.vals[k][p];
+			
+			for (int o = 0; o < Tsr_In->depth; o++)
+			{
+				float weight = Mat_Weights->vals[k][o];
+				float *inrow = Tsr_In->vals[o][p*stride];
+				
+				if (stride == 1)
+				{
+					// Contiguous axpy, vectorized by the compiler
+					for (int q = 0; q < tempcol; q++)
+					{
+						outrow[q] += weight * inrow[q];
+					}
+				}
+				else
+				{
+					for (int q = 0; q < tempcol; q++)
+					{
+						outrow[q] += weight * inrow[q*stride];
+					}
+				}
+			}
+		}
+	}
+	
+	return tempTsr;
+}
+
+Matrix convolution_2d_dilated_Mat_wCPU(Matrix *Mat_In, Matrix *Mat_kernel, int stride, int dilation)
+{
+	assert(stride > 0);
+	assert(dilation > 0);
+	
+	// Calculate the effective (dilated) kernel size
+	int kernelrow = (Mat_kernel->row - 1)*dilation + 1;
+	int kernelcol = (Mat_kernel->col - 1)*dilation + 1;
+	
+	assert(Mat_In->row >= kernelrow && Mat_In->col >= kernelcol);
+	
+	// Calculate output matrix size
+	int temprow = (Mat_In->row - kernelrow)/stride + 1;
+	int tempcol = (Mat_In->col - kernelcol)/stride + 1;
+	
+	// Create output matrix
+	Matrix tempMat = create_matrix(temprow, tempcol);
+	
+	// Output rows are independent of each other
+	#pragma omp parallel for
+	for (int p = 0; p < temprow; p++)
+	{
+		convolution_2d_row_accumulate(tempMat.vals[p], tempcol, Mat_In->vals, p*stride, 
+									  Mat_kernel->vals, Mat_kernel->row, Mat_kernel->col, 
+									  stride, dilation);
+	}
+	
+	return tempMat;
+}
+
+Tensor convolution_2d_dilated_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernel, int stride, int dilation, int filter_size)
+{
+	assert(stride > 0);
+	assert(dilation > 0);
+	assert(Tsr_In->depth == Tsr_kernel->depth);
+	
+	// Calculate the effective (dilated) kernel size
+	int kernelrow = (Tsr_kernel->row - 1)*dilation + 1;
+	int kernelcol = (Tsr_kernel->col - 1)*dilation + 1;
+	
+	assert(Tsr_In->row >= kernelrow && Tsr_In->col >= kernelcol);
+	
+	// Calculate output tensor size
+	int temprow = (Tsr_In->row - kernelrow)/stride + 1;
+	int tempcol = (Tsr_In->col - kernelcol)/stride + 1;
+	
+	// Create output tensor
+	Tensor tempTsr = create_tensor(temprow, tempcol, filter_size);
+	
+	if (filter_size == 0)
+	{
+		return tempTsr;
+	}
+	
+	// Output rows are independent of each other, each one sums over all input layers
+	#pragma omp parallel for
+	for (int p = 0; p < temprow; p++)
+	{
+		for (int o = 0; o < Tsr_kernel->depth; o++)
+		{
+			convolution_2d_row_accumulate(tempTsr.vals[0][p], tempcol, Tsr_In->vals[o], p*stride, 
+										  Tsr_kernel->vals[o], Tsr_kernel->row, Tsr_kernel->col, 
+										  stride, dilation);
+		}
+	}
+	
+	// All filters share the same kernel, replicate the first output layer
+	for (int k = 1; k < filter_size; k++)
+	{
+		for (int p = 0; p < temprow; p++)
+		{
+			memcpy(tempTsr.vals[k][p], tempTsr.vals[0][p], tempcol * sizeof(float));
+		}
+	}
+	
+	return tempTsr;
+}
+
+Tensor convolution_2d_grouped_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernels, Vector *Vec_Bias, int stride, int groups, int filter_size)
+{
+	assert(stride > 0);
+	assert(groups > 0);
+	assert(filter_size > 0);
+	assert(Tsr_In->depth % groups == 0);
+	assert(filter_size % groups == 0);
+	assert(Vec_Bias == NULL || Vec_Bias->len == filter_size);
+	
+	// Number of input channels and filters in each group
+	int group_depth = Tsr_In->depth / groups;
+	int group_filters = filter_size / groups;
+	
+	int kernelrow = Tsr_kernels[0].row;
+	int kernelcol = Tsr_kernels[0].col;
+	
+	for (int k = 0; k < filter_size; k++)
+	{
+		assert(Tsr_kernels[k].depth == group_depth);
+		assert(Tsr_kernels[k].row == kernelrow && Tsr_kernels[k].col == kernelcol);
+	}
+	
+	assert(Tsr_In->row >= kernelrow && Tsr_In->col >= kernelcol);
+	
+	// Calculate output tensor size
+	int temprow = (Tsr_In->row - kernelrow)/stride + 1;
+	int tempcol = (Tsr_In->col - kernelcol)/stride + 1;
+	
+	// Create output tensor
+	Tensor tempTsr = create_tensor(temprow, tempcol, filter_size);
+	
+	// Each filter writes its own output layer, so filters of all groups run in parallel
+	#pragma omp parallel for
+	for (int k = 0; k < filter_size; k++)
+	{
+		// Input layers of this filter's group, no copy needed
+		float ***groupvals = Tsr_In->vals + (k / group_filters) * group_depth;
+		
+		float bias = (Vec_Bias != NULL) ? Vec_Bias->vals[k] : 0.0f;
+		
+		for (int p = 0; p < temprow; p++)
+		{
+			float *outrow = tempTsr.vals[k][p];
+			
+			for (int q = 0; q < tempcol; q++)
+			{
+				outrow[q] = bias;
+			}
+			
+			for (int o = 0; o < group_depth; o++)
+			{
+				convolution_2d_row_accumulate(outrow, tempcol, groupvals[o], p*stride, 
+											  Tsr_kernels[k].vals[o], kernelrow, kernelcol, 
+											  stride, 1);
+			}
+		}
+	}
+	
+	return tempTsr;
+}
+
+Tensor convolution_2d_relu_maxpool_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernels, Vector *Vec_Bias, int stride, int filter_size, 
+											int pool_height, int pool_width, int pool_stride)
+{
+	assert(stride > 0);
+	assert(pool_stride > 0);
+	assert(pool_height > 0 && pool_width > 0);
+	assert(Vec_Bias == NULL || Vec_Bias->len == filter_size);
+	
+	int kernelrow = Tsr_kernels[0].row;
+	int kernelcol = Tsr_kernels[0].col;
+	
+	for (int k = 0; k < filter_size; k++)
+	{
+		assert(Tsr_kernels[k].depth == Tsr_In->depth);
+		assert(Tsr_kernels[k].row == kernelrow && Tsr_kernels[k].col == kernelcol);
+	}
+	
+	assert(Tsr_In->row >= kernelrow && Tsr_In->col >= kernelcol);
+	
+	// Calculate the (not materialized) convolution output size
+	int convrow = (Tsr_In->row - kernelrow)/stride + 1;
+	int convcol = (Tsr_In->col - kernelcol)/stride + 1;
+	
+	// Calculate pooled output size, the last window may be cut at the border but always
+	// starts inside the convolution output
+	int temprow = (convrow > pool_height ? convrow - pool_height + pool_stride - 1 : 0)/pool_stride + 1;
+	int tempcol = (convcol > pool_width ? convcol - pool_width + pool_stride - 1 : 0)/pool_stride + 1;
+	
+	temprow = (temprow < (convrow - 1)/pool_stride + 1) ? temprow : (convrow - 1)/pool_stride + 1;
+	tempcol = (tempcol < (convcol - 1)/pool_stride + 1) ? tempcol : (convcol - 1)/pool_stride + 1;
+	
+	// Create output tensor
+	Tensor tempTsr = create_tensor(temprow, tempcol, filter_size);
+	
+	#pragma omp parallel
+	{
+		// Ring of the last pool_height convolution output rows (conv row r in slot r % pool_height)
+		// and the column-wise max over the current pooling window
+		float *ring = malloc((size_t)pool_height * convcol * sizeof(float));
+		float *colmax = malloc(convcol * sizeof(float));
+		assert(ring != NULL && colmax != NULL);
+		
+		#pragma omp for
+		for (int k = 0; k < filter_size; k++)
+		{
+			float bias = (Vec_Bias != NULL) ? Vec_Bias->vals[k] : 0.0f;
+			
+			// Next convolution row to compute, each one is computed once
+			int nextrow = 0;
+			
+			for (int p = 0; p < temprow; p++)
+			{
+				int rowstart = p*pool_stride;
+				int rowend = (rowstart + pool_height < convrow) ? rowstart + pool_height : convrow;
+				
+				// Rows between windows (pool stride larger than pool size) are never needed
+				nextrow = (nextrow > rowstart) ? nextrow : rowstart;
+				
+				for (; nextrow < rowend; nextrow++)
+				{
+					float *convbuf = ring + (size_t)(nextrow % pool_height) * convcol;
+					
+					for (int q = 0; q < convcol; q++)
+					{
+						convbuf[q] = bias;
+					}
+					
+					for (int o = 0; o < Tsr_In->depth; o++)
+					{
+						convolution_2d_row_accumulate(convbuf, convcol, Tsr_In->vals[o], nextrow*stride, 
+													  Tsr_kernels[k].vals[o], kernelrow, kernelcol, 
+													  stride, 1);
+					}
+				}
+				
+				// ReLU output is never negative, starting at 0 applies ReLU inside the max
+				for (int q = 0; q < convcol; q++)
+				{
+					colmax[q] = 0.0f;
+				}
+				
+				for (int r = rowstart; r < rowend; r++)
+				{
+					float *convbuf = ring + (size_t)(r % pool_height) * convcol;
+					
+					for (int q = 0; q < convcol; q++)
+					{
+						colmax[q] = fmaxf(colmax[q], convbuf[q]);
+					}
+				}
+				
+				// Reduce the pooling window along the row
+				for (int q = 0; q < tempcol; q++)
+				{
+					int colstart = q*pool_stride;
+					int colend = (colstart + pool_width < convcol) ? colstart + pool_width : convcol;
+					
+					float tempmax = 0.0f;
+					
+					for (int n = colstart; n < colend; n++)
+					{
+						tempmax = fmaxf(tempmax, colmax[n]);
+					}
+					
+					tempTsr.vals[k][p][q] = tempmax;
+				}
+			}
+		}
+		
+		free(ring);
+		free(colmax);
+	}
+	
+	return tempTsr;
+}
+
+Tensor convolution_2d_transposed_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernels, Vector *Vec_Bias, int stride, int padsize, int filter_size)
+{
+	assert(stride > 0);
+	assert(padsize >= 0);
+	assert(Vec_Bias == NULL || Vec_Bias->len == filter_size);
+	
+	int kernelrow = Tsr_kernels[0].row;
+	int kernelcol = Tsr_kernels[0].col;
+	
+	for (int k = 0; k < filter_size; k++)
+	{
+		assert(Tsr_kernels[k].depth == Tsr_In->depth);
+		assert(Tsr_kernels[k].row == kernelrow && Tsr_kernels[k].col == kernelcol);
+	}
+	
+	// Calculate output tensor size
+	int temprow = (Tsr_In->row - 1)*stride - 2*padsize + kernelrow;
+	int tempcol = (Tsr_In->col - 1)*stride - 2*padsize + kernelcol;
+	
+	assert(temprow > 0 && tempcol > 0);
+	
+	// Create output tensor
+	Tensor tempTsr = create_tensor(temprow, tempcol, filter_size);
+	
+	// Each filter scatters into its own output layer
+	#pragma omp parallel for
+	for (int k = 0; k < filter_size; k++)
+	{
+		float bias = (Vec_Bias != NULL) ? Vec_Bias->vals[k] : 0.0f;
+		
+		for (int p = 0; p < temprow; p++)
+		{
+			for (int q = 0; q < tempcol; q++)
+			{
+				tempTsr.vals[k][p][q] = bias;
+			}
+		}
+		
+		for (int o = 0; o < Tsr_In->depth; o++)
+		{
+			for (int i = 0; i < Tsr_In->row; i++)
+			{
+				float *inrow = Tsr_In->vals[o][i];
+				
+				for (int m = 0; m < kernelrow; m++)
+				{
+					// Input row i reaches output row i*stride + m - padsize
+					int p = i*stride + m - padsize;
+					
+					if (p < 0 || p >= temprow)
+					{
+						continue;
+					}
+					
+					float *outrow = tempTsr.vals[k][p];
+					
+					for (int n = 0; n < kernelcol; n++)
+					{
+						float weight = Tsr_kernels[k].vals[o][m][n];
+						
+						// Range of input columns j whose output column j*stride + n - padsize is inside
+						int lowest = padsize - n;
+						int highest = tempcol - 1 + padsize - n;
+						
+						if (highest < 0)
+						{
+							continue;
+						}
+						
+						int jstart = (lowest > 0) ? (lowest + stride - 1)/stride : 0;
+						int jend = highest/stride + 1;
+						
+						if (jend > Tsr_In->col)
+						{
+							jend = Tsr_In->col;
+						}
+						
+						int offset = n - padsize;
+						
+						for (int j = jstart; j < jend; j++)
+						{
+							outrow[j*stride + offset] += weight * inrow[j];
+						}
+					}
+				}
+			}
+		}
+	}
+	
+	return tempTsr;
+}
+
+Conv1D_Stream create_conv1d_stream(Matrix *Mat_kernels)
+{
+	assert(Mat_kernels->col > 0);
+	
+	Conv1D_Stream S;
+	
+	S.channels = Mat_kernels->row;
+	S.len = Mat_kernels->col;
+	S.head = 0;
+	S.kernels = copy_Mat_wCPU(Mat_kernels);
+	S.history = create_matrix(S.channels, S.len - 1);
+	
+	return S;
+}
+
+void reset_conv1d_stream(Conv1D_Stream *Stream)
+{
+	for (int c = 0; c < Stream->channels; c++)
+	{
+		memset(Stream->history.vals[c], 0, (Stream->len - 1) * sizeof(float));
+	}
+	
+	Stream->head = 0;
+}
+
+void free_conv1d_stream(Conv1D_Stream *Stream)
+{
+	free_matrix(&Stream->kernels);
+	free_matrix(&Stream->history);
+}
+
+Vector convolution_1d_stream_Vec_wCPU(Conv1D_Stream *Stream, Vector *Vec_In)
+{
+	assert(Stream->channels == 1);
+	
+	// Wrap the vector as a single row matrix, no copy
+	Matrix tempIn;
+	tempIn.row = 1;
+	tempIn.col = Vec_In->len;
+	tempIn.vals = &Vec_In->vals;
+	tempIn.view = 1;
+	
+	Matrix tempOut = convolution_1d_stream_Mat_wCPU(Stream, &tempIn);
+	
+	// Hand over the output row to a vector
+	Vector tempVec;
+	tempVec.len = tempOut.col;
+	tempVec.vals = tempOut.vals[0];
+	tempVec.view = 0;
+	
+	free(tempOut.vals);
+	
+	return tempVec;
+}
+
+Matrix convolution_1d_stream_Mat_wCPU(Conv1D_Stream *Stream, Matrix *Mat_In)
+{
+	assert(Mat_In->row == Stream->channels);
+	
+	int len = Mat_In->col;
+	int histlen = Stream->len - 1;
+	int head = Stream->head;
+	
+	Matrix tempMat = create_matrix(Stream->channels, len);
+	
+	#pragma omp parallel for
+	for (int c = 0; c < Stream->channels; c++)
+	{
+		float *in = Mat_In->vals[c];
+		float *out = tempMat.vals[c];
+		float *kernel = Stream->kernels.vals[c];
+		float *hist = Stream->history.vals[c];
+		
+		// Outputs whose window starts before the chunk read the oldest part from history
+		int edge = (histlen < len) ? histlen : len;
+		
+		for (int t = 0; t < edge; t++)
+		{
+			float tempsum = 0.0f;
+			
+			for (int m = 0; m < Stream->len; m++)
+			{
+				// Window position relative to the start of the chunk
+				int idx = t - histlen + m;
+				
+				tempsum += kernel[m] * ((idx < 0) ? hist[(head + histlen + idx) % histlen] : in[idx]);
+			}
+			
+			out[t] = tempsum;
+		}
+		
+		// Remaining outputs only read the chunk, loop per kernel tap to vectorize
+		for (int m = 0; m < Stream->len; m++)
+		{
+			float weight = kernel[m];
+			int offset = m - histlen;
+			
+			for (int t = edge; t < len; t++)
+			{
+				out[t] += weight * in[t + offset];
+			}
+		}
+		
+		// Keep the last len-1 samples for the next chunk
+		if (histlen == 0)
+		{
+			continue;
+		}
+		
+		if (len >= histlen)
+		{
+			memcpy(hist, in + len - histlen, histlen * sizeof(float));
+		}
+		else
+		{
+			for (int t = 0; t < len; t++)
+			{
+				hist[(head + t) % histlen] = in[t];
+			}
+		}
+	}
+	
+	// Oldest sample position is shared by all channels
+	if (histlen > 0)
+	{
+		Stream->head = (len >= histlen) ? 0 : (head + len) % histlen;
+	}
+	
+	return tempMat;
+}
+
+// Direct algorithm: one dot product per output element of the first layer
+static void convolution_2d_direct_layer(Tensor *Tsr_In, Tensor *Tsr_kernel, int stride, Matrix *Mat_Out)
+{
+	#pragma omp parallel for
+	for (int p = 0; p < Mat_Out->row; p++)
+	{
+		for (int q = 0; q < Mat_Out->col; q++)
+		{
+			float tempsum = 0.0f;
+			
+			for (int o = 0; o < Tsr_kernel->depth; o++)
+			{
+				for (int m = 0; m < Tsr_kernel->row; m++)
+				{
+					float *inrow = Tsr_In->vals[o][p*stride + m] + q*stride;
+					float *kernelrow = Tsr_kernel->vals[o][m];
+					
+					for (int n = 0; n < Tsr_kernel->col; n++)
+					{
+						tempsum += inrow[n] * kernelrow[n];
+					}
+				}
+			}
+			
+			Mat_Out->vals[p][q] = tempsum;
+		}
+	}
+}
+
+Tensor convolution_2d_algo_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernel, int stride, int filter_size, Conv_Algorithm algorithm)
+{
+	assert(stride > 0);
+	assert(Tsr_In->depth == Tsr_kernel->depth);
+	assert(Tsr_In->row >= Tsr_kernel->row && Tsr_In->col >= Tsr_kernel->col);
+	
+	switch (algorithm)
+	{
+		case CONV_ALGO_ROW:
+			return convolution_2d_dilated_Tsr_wCPU(Tsr_In, Tsr_kernel, stride, 1, filter_size);
+		
+		case CONV_ALGO_POINTWISE:
+			assert(Tsr_kernel->row == 1 && Tsr_kernel->col == 1);
+			return convolution_2d_Tsr_wCPU(Tsr_In, Tsr_kernel, stride, filter_size);
+		
+		default:
+			break;
+	}
+	
+	// Calculate output tensor size
+	int temprow = (Tsr_In->row - Tsr_kernel->row)/stride + 1;
+	int tempcol = (Tsr_In->col - Tsr_kernel->col)/stride + 1;
+	
+	Tensor tempTsr = create_tensor(temprow, tempcol, filter_size);
+	
+	if (filter_size == 0)
+	{
+		return tempTsr;
+	}
+	
+	// Compute the first output layer in place
+	Matrix tempLayer;
+	tempLayer.row = temprow;
+	tempLayer.col = tempcol;
+	tempLayer.vals = tempTsr.vals[0];
+	tempLayer.view = 1;
+	
+	convolution_2d_direct_layer(Tsr_In, Tsr_kernel, stride, &tempLayer);
+	
+	// All filters share the same kernel, replicate the first output layer
+	for (int k = 1; k < filter_size; k++)
+	{
+		for (int p = 0; p < temprow; p++)
+		{
+			memcpy(tempTsr.vals[k][p], tempTsr.vals[0][p], tempcol * sizeof(float));
+		}
+	}
+	
+	return tempTsr;
+}
+
+// Convolution plan: shape key and the fastest algorithm for it
+#define CONV_PLAN_KEYS 10
+
+typedef struct Conv_Plan
+{
+	int key[CONV_PLAN_KEYS];
+	Conv_Algorithm algorithm;
+} Conv_Plan;
+
+static Conv_Plan *conv_plans = NULL;
+static int conv_plan_count = 0;
+static int conv_plan_capacity = 0;
+
+static int conv_threads(void)
+{
+#ifdef _OPENMP
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+static double conv_wall_time(void)
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static void conv_plan_key(int *key, Tensor *Tsr_In, int padsize, Tensor *Tsr_kernel, int stride, int filter_size)
+{
+	key[0] = Tsr_In->row;
+	key[1] = Tsr_In->col;
+	key[2] = Tsr_In->depth;
+	key[3] = Tsr_kernel->row;
+	key[4] = Tsr_kernel->col;
+	key[5] = Tsr_kernel->depth;
+	key[6] = stride;
+	key[7] = padsize;
+	key[8] = filter_size;
+	key[9] = conv_threads();
+}
+
+static Conv_Plan *find_conv_plan(int *key)
+{
+	for (int i = 0; i < conv_plan_count; i++)
+	{
+		if (memcmp(conv_plans[i].key, key, sizeof(conv_plans[i].key)) == 0)
+		{
+			return &conv_plans[i];
+		}
+	}
+	
+	return NULL;
+}
+
+static void add_conv_plan(int *key, Conv_Algorithm algorithm)
+{
+	Conv_Plan *plan = find_conv_plan(key);
+	
+	if (plan == NULL)
+	{
+		if (conv_plan_count == conv_plan_capacity)
+		{
+			int tempcapacity = (conv_plan_capacity == 0) ? 16 : 2*conv_plan_capacity;
+			Conv_Plan *tempPlans = realloc(conv_plans, tempcapacity * sizeof(Conv_Plan));
+			
+			assert(tempPlans != NULL);
+			
+			conv_plans = tempPlans;
+			conv_plan_capacity = tempcapacity;
+		}
+		
+		plan = &conv_plans[conv_plan_count++];
+		memcpy(plan->key, key, sizeof(plan->key));
+	}
+	
+	plan->algorithm = algorithm;
+}
+
+Conv_Algorithm convolution_2d_plan_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr_kernel, int stride, int filter_size)
+{
+	int key[CONV_PLAN_KEYS];
+	conv_plan_key(key, Tsr_In, padsize, Tsr_kernel, stride, filter_size);
+	
+	Conv_Plan *plan = find_conv_plan(key);
+	
+	if (plan != NULL)
+	{
+		return plan->algorithm;
+	}
+	
+	Tensor tempIn = (padsize > 0) ? padding_2d_Tsr_wCPU(Tsr_In, padsize) : *Tsr_In;
+	
+	Conv_Algorithm best = CONV_ALGO_ROW;
+	double besttime = 0.0;
+	
+	for (int a = 0; a < CONV_ALGO_COUNT; a++)
+	{
+		if (a == CONV_ALGO_POINTWISE && (Tsr_kernel->row != 1 || Tsr_kernel->col != 1))
+		{
+			continue;
+		}
+		
+		// Best of two runs, the first one also warms up the caches
+		for (int run = 0; run < 2; run++)
+		{
+			double start = conv_wall_time();
+			Tensor tempOut = convolution_2d_algo_Tsr_wCPU(&tempIn, Tsr_kernel, stride, filter_size, (Conv_Algorithm)a);
+			double elapsed = conv_wall_time() - start;
+			
+			free_tensor(&tempOut);
+			
+			if ((a == 0 && run == 0) || elapsed < besttime)
+			{
+				best = (Conv_Algorithm)a;
+				besttime = elapsed;
+			}
+		}
+	}
+	
+	if (padsize > 0)
+	{
+		free_tensor(&tempIn);
+	}
+	
+	add_conv_plan(key, best);
+	
+	return best;
+}
+
+Tensor convolution_2d_tuned_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr_kernel, int stride, int filter_size)
+{
+	assert(stride > 0);
+	assert(padsize >= 0);
+	
+	Conv_Algorithm algorithm = convolution_2d_plan_Tsr_wCPU(Tsr_In, padsize, Tsr_kernel, stride, filter_size);
+	
+	if (padsize == 0)
+	{
+		return convolution_2d_algo_Tsr_wCPU(Tsr_In, Tsr_kernel, stride, filter_size, algorithm);
+	}
+	
+	Tensor tempIn = padding_2d_Tsr_wCPU(Tsr_In, padsize);
+	Tensor tempTsr = convolution_2d_algo_Tsr_wCPU(&tempIn, Tsr_kernel, stride, filter_size, algorithm);
+	
+	free_tensor(&tempIn);
+	
+	return tempTsr;
+}
+
+int save_conv_plans(const char *filename)
+{
+	FILE *file = fopen(filename, "w");
+	
+	if (file == NULL)
+	{
+		return -1;
+	}
+	
+	// One plan per line: key values followed by the algorithm
+	for (int i = 0; i < conv_plan_count; i++)
+	{
+		for (int j = 0; j < CONV_PLAN_KEYS; j++)
+		{
+			fprintf(file, "%d ", conv_plans[i].key[j]);
+		}
+		
+		fprintf(file, "%d\n", (int)conv_plans[i].algorithm);
+	}
+	
+	fclose(file);
+	
+	return conv_plan_count;
+}
+
+int load_conv_plans(const char *filename)
+{
+	FILE *file = fopen(filename, "r");
+	
+	if (file == NULL)
+	{
+		return -1;
+	}
+	
+	int count = 0;
+	int key[CONV_PLAN_KEYS];
+	int algorithm;
+	
+	while (1)
+	{
+		int j = 0;
+		
+		while (j < CONV_PLAN_KEYS && fscanf(file, "%d", &key[j]) == 1)
+		{
+			j++;
+		}
+		
+		if (j < CONV_PLAN_KEYS || fscanf(file, "%d", &algorithm) != 1)
+		{
+			break;
+		}
+		
+		// Plans from another version may name an algorithm that no longer applies
+		int applicable = algorithm >= 0 && algorithm < CONV_ALGO_COUNT &&
+						 (algorithm != CONV_ALGO_POINTWISE || (key[3] == 1 && key[4] == 1));
+		
+		if (applicable)
+		{
+			add_conv_plan(key, (Conv_Algorithm)algorithm);
+			count++;
+		}
+	}
+	
+	fclose(file);
+	
+	return count;
+}
+
+void clear_conv_plans(void)
+{
+	free(conv_plans);
+	
+	conv_plans = NULL;
+	conv_plan_count = 0;
+	conv_plan_capacity = 0;
+}
+
+int separate_kernel_Mat_wCPU(Matrix *Mat_kernel, Vector *Vec_col_kernel, Vector *Vec_row_kernel, float tolerance)
+{
+	// Largest absolute value is used as pivot
+	int pivotrow = 0;
+	int pivotcol = 0;
+	float maxabs = 0.0f;
+	
+	for (int m = 0; m < Mat_kernel->row; m++)
+	{
+		for (int n = 0; n < Mat_kernel->col; n++)
+		{
+			if (fabsf(Mat_kernel->vals[m][n]) > maxabs)
+			{
+				maxabs = fabsf(Mat_kernel->vals[m][n]);
+				pivotrow = m;
+				pivotcol = n;
+			}
+		}
+	}
+	
+	Vector tempCol = create_vector(Mat_kernel->row);
+	Vector tempRow = create_vector(Mat_kernel->col);
+	
+	// A rank-1 kernel is its pivot column times its pivot row scaled by the pivot
+	if (maxabs > 0.0f)
+	{
+		float pivot = Mat_kernel->vals[pivotrow][pivotcol];
+		
+		for (int m = 0; m < Mat_kernel->row; m++)
+		{
+			tempCol.vals[m] = Mat_kernel->vals[m][pivotcol];
+		}
+		
+		for (int n = 0; n < Mat_kernel->col; n++)
+		{
+			tempRow.vals[n] = Mat_kernel->vals[pivotrow][n] / pivot;
+		}
+	}
+	
+	for (int m = 0; m < Mat_kernel->row; m++)
+	{
+		for (int n = 0; n < Mat_kernel->col; n++)
+		{
+			if (fabsf(Mat_kernel->vals[m][n] - tempCol.vals[m]*tempRow.vals[n]) > tolerance*maxabs)
+			{
+				free_vector(&tempCol);
+				free_vector(&tempRow);
+				
+				return 0;
+			}
+		}
+	}
+	
+	*Vec_col_kernel = tempCol;
+	*Vec_row_kernel = tempRow;
+	
+	return 1;
+}
+
+Matrix convolution_2d_separable_Mat_wCPU(Matrix *Mat_In, Vector *Vec_col_kernel, Vector *Vec_row_kernel, int stride)
+{
+	assert(stride > 0);
+	assert(Mat_In->row >= Vec_col_kernel->len && Mat_In->col >= Vec_row_kernel->len);
+	
+	int kernelrow = Vec_col_kernel->len;
+	int kernelcol = Vec_row_kernel->len;
+	
+	// Calculate output matrix size
+	int temprow = (Mat_In->row - kernelrow)/stride + 1;
+	int tempcol = (Mat_In->col - kernelcol)/stride + 1;
+	
+	// Create output matrix
+	Matrix tempMat = create_matrix(temprow, tempcol);
+	
+	// Static schedule hands every thread one contiguous block of output rows, so the
+	// ring of the last kernelrow row-pass results carries over from row to row and
+	// each input row is filtered once per thread
+	#pragma omp parallel
+	{
+		Matrix tempRing = create_matrix(kernelrow, tempcol);
+		
+		// Highest input row already filtered by the row pass
+		int lastrow = -1;
+		
+		#pragma omp for schedule(static)
+		for (int p = 0; p < temprow; p++)
+		{
+			int first = p*stride;
+			
+			// Row pass on the input rows that are not in the ring yet
+			for (int r = (lastrow + 1 > first) ? lastrow + 1 : first; r < first + kernelrow; r++)
+			{
+				float *ringrow = tempRing.vals[r % kernelrow];
+				float *inrow = Mat_In->vals[r];
+				
+				for (int q = 0; q < tempcol; q++)
+				{
+					ringrow[q] = 0.0f;
+				}
+				
+				for (int n = 0; n < kernelcol; n++)
+				{
+					float weight = Vec_row_kernel->vals[n];
+					
+					for (int q = 0; q < tempcol; q++)
+					{
+						ringrow[q] += weight * inrow[q*stride + n];
+					}
+				}
+			}
+			
+			lastrow = first + kernelrow - 1;
+			
+			// Column pass over the ring
+			float *outrow = tempMat.vals[p];
+			
+			for (int m = 0; m < kernelrow; m++)
+			{
+				float weight = Vec_col_kernel->vals[m];
+				float *ringrow = tempRing.vals[(first + m) % kernelrow];
+				
+				for (int q = 0; q < tempcol; q++)
+				{
+					outrow[q] += weight * ringrow[q];
+				}
+			}
+		}
+		
+		free_matrix(&tempRing);
+	}
+	
+	return tempMat;
+}
+
+// Accumulate one output row of a 2D convolution with borders resolved on the fly.
+// p0 is the top row of the receptive field in padded coordinates, colmap maps padded
+// columns to input columns (-1 for the constant value). Output columns [qstart, qend) 
+// only read inside the input and take the contiguous path.
+static void convolution_2d_border_row_accumulate(float *outrow, int tempcol, float **invals, int inrow, int p0,
+												 float **kernelvals, int kernelrow, int kernelcol, int stride, int padsize,
+												 int *colmap, int qstart, int qend, Border_Mode mode, float value)
+{
+	for (int m = 0; m < kernelrow; m++)
+	{
+		int i = border_index(p0 + m - padsize, inrow, mode);
+		float *inrow_vals = (i >= 0) ? invals[i] : NULL;
+		
+		for (int n = 0; n < kernelcol; n++)
+		{
+			float weight = kernelvals[m][n];
+			
+			// Whole receptive field row is the constant value
+			if (inrow_vals == NULL)
+			{
+				for (int q = 0; q < tempcol; q++)
+				{
+					outrow[q] += weight * value;
+				}
+				
+				continue;
+			}
+			
+			int offset = n - padsize;
+			
+			for (int q = qstart; q < qend; q++)
+			{
+				outrow[q] += weight * inrow_vals[q*stride + offset];
+			}
+			
+			// Left and right border columns go through the column map
+			for (int q = 0; q < qstart; q++)
+			{
+				int j = colmap[q*stride + n];
+				
+				outrow[q] += weight * ((j >= 0) ? inrow_vals[j] : value);
+			}
+			
+			for (int q = qend; q < tempcol; q++)
+			{
+				int j = colmap[q*stride + n];
+				
+				outrow[q] += weight * ((j >= 0) ? inrow_vals[j] : value);
+			}
+		}
+	}
+}
+
+// Column map and the range of output columns that are inside the input for all kernel taps
+static int *convolution_2d_border_colmap(int incol, int kernelcol, int tempcol, int stride, int padsize, 
+										 Border_Mode mode, int *qstart, int *qend)
+{
+	int linecol = (tempcol - 1)*stride + kernelcol;
+	int *colmap = malloc(linecol * sizeof(int));
+	
+	for (int x = 0; x < linecol; x++)
+	{
+		colmap[x] = border_index(x - padsize, incol, mode);
+	}
+	
+	*qstart = (padsize + stride - 1)/stride;
+	*qend = (incol - kernelcol + padsize >= 0) ? (incol - kernelcol + padsize)/stride + 1 : 0;
+	
+	if (*qend > tempcol)
+	{
+		*qend = tempcol;
+	}
+	
+	if (*qstart > *qend)
+	{
+		*qstart = *qend;
+	}
+	
+	return colmap;
+}
+
+Matrix convolution_2d_with_border_Mat_wCPU(Matrix *Mat_In, int padsize, Matrix *Mat_kernel, int stride, Border_Mode mode, float value)
+{
+	assert(stride > 0);
+	assert(padsize >= 0);
+	assert(Mat_In->row + 2*padsize >= Mat_kernel->row && Mat_In->col + 2*padsize >= Mat_kernel->col);
+	
+	// Calculate output matrix size
+	int temprow = (Mat_In->row + 2*padsize - Mat_kernel->row)/stride + 1;
+	int tempcol = (Mat_In->col + 2*padsize - Mat_kernel->col)/stride + 1;
+	
+	Matrix tempMat = create_matrix(temprow, tempcol);
+	
+	int qstart, qend;
+	int *colmap = convolution_2d_border_colmap(Mat_In->col, Mat_kernel->col, tempcol, stride, padsize, mode, &qstart, &qend);
+	
+	#pragma omp parallel for
+	for (int p = 0; p < temprow; p++)
+	{
+		convolution_2d_border_row_accumulate(tempMat.vals[p], tempcol, Mat_In->vals, Mat_In->row, p*stride,
+											 Mat_kernel->vals, Mat_kernel->row, Mat_kernel->col, stride, padsize,
+											 colmap, qstart, qend, mode, value);
+	}
+	
+	free(colmap);
+	
+	return tempMat;
+}
+
+Tensor convolution_2d_with_border_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr_kernel, int stride, int filter_size, Border_Mode mode, float value)
+{
+	assert(stride > 0);
+	assert(padsize >= 0);
+	assert(Tsr_In->depth == Tsr_kernel->depth);
+	assert(Tsr_In->row + 2*padsize >= Tsr_kernel->row && Tsr_In->col + 2*padsize >= Tsr_kernel->col);
+	
+	// Calculate output tensor size
+	int temprow = (Tsr_In->row + 2*padsize - Tsr_kernel->row)/stride + 1;
+	int tempcol = (Tsr_In->col + 2*padsize - Tsr_kernel->col)/stride + 1;
+	
+	Tensor tempTsr = create_tensor(temprow, tempcol, filter_size);
+	
+	if (filter_size == 0)
+	{
+		return tempTsr;
+	}
+	
+	int qstart, qend;
+	int *colmap = convolution_2d_border_colmap(Tsr_In->col, Tsr_kernel->col, tempcol, stride, padsize, mode, &qstart, &qend);
+	
+	#pragma omp parallel for
+	for (int p = 0; p < temprow; p++)
+	{
+		for (int o = 0; o < Tsr_kernel->depth; o++)
+		{
+			convolution_2d_border_row_accumulate(tempTsr.vals[0][p], tempcol, Tsr_In->vals[o], Tsr_In->row, p*stride,
+												 Tsr_kernel->vals[o], Tsr_kernel->row, Tsr_kernel->col, stride, padsize,
+												 colmap, qstart, qend, mode, value);
+		}
+	}
+	
+	free(colmap);
+	
+	// All filters share the same kernel, replicate the first output layer
+	for (int k = 1; k < filter_size; k++)
+	{
+		for (int p = 0; p < temprow; p++)
+		{
+			memcpy(tempTsr.vals[k][p], tempTsr.vals[0][p], tempcol * sizeof(float));
+		}
+	}
+	
+	return tempTsr;
+}
+
+void fold_batchnorm_conv_wCPU(Tensor *Tsr_kernels, Vector *Vec_Bias, int filter_size, Vector *Vec_Gamma, Vector *Vec_Beta, 
+							  Vector *Vec_Mean, Vector *Vec_Var, float eps)
+{
+	assert(Vec_Bias->len == filter_size);
+	assert(Vec_Mean->len == filter_size && Vec_Var->len == filter_size);
+	assert(Vec_Gamma == NULL || Vec_Gamma->len == filter_size);
+	assert(Vec_Beta == NULL || Vec_Beta->len == filter_size);
+	
+	for (int k = 0; k < filter_size; k++)
+	{
+		float gamma = (Vec_Gamma != NULL) ? Vec_Gamma->vals[k] : 1.0f;
+		float beta = (Vec_Beta != NULL) ? Vec_Beta->vals[k] : 0.0f;
+		
+		// BN(conv(x) + b) = scale*conv(x) + scale*(b - mean) + beta, and conv is linear in its kernel
+		float scale = gamma/sqrtf(Vec_Var->vals[k] + eps);
+		
+		for (int o = 0; o < Tsr_kernels[k].depth; o++)
+		{
+			for (int i = 0; i < Tsr_kernels[k].row; i++)
+			{
+				for (int j = 0; j < Tsr_kernels[k].col; j++)
+				{
+					Tsr_kernels[k].vals[o][i][j] *= scale;
+				}
+			}
+		}
+		
+		Vec_Bias->vals[k] = (Vec_Bias->vals[k] - Vec_Mean->vals[k])*scale + beta;
+	}
+}
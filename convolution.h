@@ -54,6 +54,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
+#include <string.h>
 
 #include "vector.h"
 #include "matrix.h"
@@ -61,6 +62,37 @@
 
 #include "padding.h"
 
+/**
+ * @brief	Streaming 1D convolution state
+ * 
+ * Holds one kernel per channel and a ring buffer with the last (kernel length - 1)
+ * input samples of each channel, so that a continuous signal can be convolved 
+ * chunk by chunk without keeping or revisiting older samples.
+ */
+typedef struct Conv1D_Stream
+{
+	int channels;		/**< number of independent signal channels */
+	int len;			/**< kernel length */
+	int head;			/**< ring buffer index of the oldest sample in history */
+	Matrix kernels;		/**< kernel of each channel, channels x len */
+	Matrix history;		/**< ring buffer of the last len-1 samples, channels x (len-1) */
+} Conv1D_Stream;
+
+/**
+ * @brief	Convolution algorithms selectable by the convolution planner
+ * 
+ * CONV_ALGO_DIRECT and CONV_ALGO_ROW are two loop orders of the same direct convolution,
+ * so for kernels larger than 1x1 the planner only picks a loop order. 
+ * CONV_ALGO_POINTWISE is added as a candidate for 1x1 kernels.
+ */
+typedef enum Conv_Algorithm
+{
+	CONV_ALGO_DIRECT = 0,	/**< output-major loops, one dot product per output element */
+	CONV_ALGO_ROW,			/**< kernel-tap-major loops, vectorized along output rows */
+	CONV_ALGO_POINTWISE,	/**< direct matrix multiplication over channels, 1x1 kernels only */
+	CONV_ALGO_COUNT			/**< number of algorithms */
+} Conv_Algorithm;
+
 /**
  * @brief	Valid 2D convolution on matrix
  * @param 	Mat_In
@@ -82,7 +114,8 @@ Matrix convolution_2d_Mat_wCPU(Matrix *Mat_In, Matrix *Mat_kernel, int stride);
  * @return 	matrix
  * @note	stride value must be more than 0
  * 
- * This function performs 2D same convolution on the input matrix 
+ * This function performs 2D same convolution on the input matrix.
+ * The input is padded into a temporary, the input matrix is not modified.
  */
 Matrix convolution_2d_with_pad_Mat_wCPU(Matrix *Mat_In, int padsize, Matrix *Mat_kernel, int stride);
 
@@ -96,7 +129,8 @@ Matrix convolution_2d_with_pad_Mat_wCPU(Matrix *Mat_In, int padsize, Matrix *Mat
  * @note	stride value must be more than 0
  * 
  * This function performs 2D valid convolution on the input tensor 
- * and return a new tensor based on the specified filter size  
+ * and return a new tensor based on the specified filter size.\n
+ * 1x1 kernels are detected and computed by convolution_2d_pointwise_Tsr_wCPU()
  */
 Tensor convolution_2d_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernel, int stride, int filter_size);
 
@@ -110,8 +144,368 @@ Tensor convolution_2d_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernel, int stride, i
  * @note	stride value must be more than 0
  * 
  * This function performs 2D same convolution on the input tensor 
- * and return a new tensor based on the specified filter size  
+ * and return a new tensor based on the specified filter size.
+ * The input is padded into a temporary, the input tensor is not modified.
  */
 Tensor convolution_2d_with_pad_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr_kernel, int stride, int filter_size);
 
+/**
+ * @brief	Pointwise (1x1) 2D convolution on tensor
+ * @param 	Tsr_In
+ * @param 	Mat_Weights
+ * @param 	stride
+ * @return 	Tensor
+ * @note	
+ * 1. stride value must be more than 0
+ * 2. Weight matrix's column must be the same to input tensor's depth
+ * 3. Weight matrix's row defines the number of filters, i.e. output tensor's depth
+ * 4. Input tensor's row and col must be more than 0
+ * 
+ * This function performs 1x1 convolution as a direct matrix multiplication (GEMM)
+ * over channels, i.e. (filters x pixels) = (filters x channels) * (channels x pixels).\n
+ * The input tensor is read in place without im2col copy. Strided convolution reads
+ * a subsampled view of the input rows and columns.
+ */
+Tensor convolution_2d_pointwise_Tsr_wCPU(Tensor *Tsr_In, Matrix *Mat_Weights, int stride);
+
+/**
+ * @brief	Dilated 2D convolution on matrix
+ * @param 	Mat_In
+ * @param 	Mat_kernel
+ * @param 	stride
+ * @param 	dilation
+ * @return 	matrix
+ * @note	stride and dilation value must be more than 0
+ * 
+ * This function performs 2D valid dilated (atrous) convolution on the input matrix.\n
+ * Kernel taps are spaced dilation elements apart, so the effective kernel size is
+ * (kernel size - 1)*dilation + 1. Only the non-zero taps are multiplied.
+ * A dilation of 1 is the same as convolution_2d_Mat_wCPU().
+ */
+Matrix convolution_2d_dilated_Mat_wCPU(Matrix *Mat_In, Matrix *Mat_kernel, int stride, int dilation);
+
+/**
+ * @brief	Dilated 2D convolution on tensor
+ * @param 	Tsr_In
+ * @param 	Tsr_kernel
+ * @param 	stride
+ * @param 	dilation
+ * @param	filter_size
+ * @return 	Tensor
+ * @note	stride and dilation value must be more than 0
+ * 
+ * This function performs 2D valid dilated (atrous) convolution on the input tensor 
+ * and return a new tensor based on the specified filter size.\n
+ * A dilation of 1 is the same as convolution_2d_Tsr_wCPU().
+ */
+Tensor convolution_2d_dilated_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernel, int stride, int dilation, int filter_size);
+
+/**
+ * @brief	Grouped 2D convolution on tensor
+ * @param 	Tsr_In
+ * @param 	Tsr_kernels
+ * @param 	Vec_Bias
+ * @param 	stride
+ * @param	groups
+ * @param	filter_size
+ * @return 	Tensor
+ * @note	
+ * 1. stride, groups and filter_size value must be more than 0
+ * 2. Input tensor's depth and filter_size must be divisible by groups
+ * 3. Tsr_kernels is an array of filter_size kernels, each with depth of Tsr_In->depth/groups
+ * 4. Vec_Bias is optional (NULL for no bias), otherwise its length must be filter_size
+ * 
+ * This function performs 2D valid grouped convolution on the input tensor.\n
+ * Input channels and filters are split into groups; filter k only convolves with the 
+ * channel range of its group, i.e. channels [g*depth/groups, (g+1)*depth/groups) where
+ * g = k/(filter_size/groups). The channel ranges are read in place without copy.
+ * groups of 1 is a regular multi-filter convolution, groups equal to input depth is a
+ * depthwise convolution. Filters (and therefore groups) are computed in parallel.
+ */
+Tensor convolution_2d_grouped_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernels, Vector *Vec_Bias, int stride, int groups, int filter_size);
+
+/**
+ * @brief	Fused 2D convolution, ReLU and maxpooling on tensor
+ * @param 	Tsr_In
+ * @param 	Tsr_kernels
+ * @param 	Vec_Bias
+ * @param 	stride
+ * @param	filter_size
+ * @param	pool_height
+ * @param	pool_width
+ * @param	pool_stride
+ * @return 	Tensor
+ * @note	
+ * 1. stride and pool_stride value must be more than 0
+ * 2. Tsr_kernels is an array of filter_size kernels, each with the same depth as the input tensor
+ * 3. Vec_Bias is optional (NULL for no bias), otherwise its length must be filter_size
+ * 
+ * This function computes the same result as convolution (valid), ReLU and then maxpooling,
+ * but without materializing the convolution or ReLU output tensors.\n
+ * Each convolution output row is computed once into a ring of pool_height rows and reduced
+ * into the pooling windows while it is still in cache; only the pooled output is written to
+ * memory, and overlapping windows (pool size larger than pool stride) share the ring rows.\n
+ * As in maxpooling_Tsr_wCPU(), the last pooling window is cut at the border of the 
+ * convolution output, e.g. pool size equal to pool stride gives ceil(size/stride) outputs,
+ * and every window starts inside the convolution output.
+ */
+Tensor convolution_2d_relu_maxpool_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernels, Vector *Vec_Bias, int stride, int filter_size, 
+											int pool_height, int pool_width, int pool_stride);
+
+/**
+ * @brief	Transposed 2D convolution on tensor
+ * @param 	Tsr_In
+ * @param 	Tsr_kernels
+ * @param 	Vec_Bias
+ * @param 	stride
+ * @param	padsize
+ * @param	filter_size
+ * @return 	Tensor
+ * @note	
+ * 1. stride value must be more than 0, padsize value must not be negative
+ * 2. Tsr_kernels is an array of filter_size kernels, each with the same depth as the input tensor
+ * 3. Vec_Bias is optional (NULL for no bias), otherwise its length must be filter_size
+ * 
+ * This function performs transposed convolution (also known as deconvolution or learned
+ * upsampling), the gradient of a strided convolution with respect to its input.\n
+ * Output size is (input size - 1)*stride - 2*padsize + kernel size. 
+ * Each input element is scattered into the output through the kernel, so the zeros that 
+ * an upsampled-and-padded input would contain are never multiplied.
+ */
+Tensor convolution_2d_transposed_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernels, Vector *Vec_Bias, int stride, int padsize, int filter_size);
+
+/**
+ * @brief	Create streaming 1D convolution
+ * @param 	Mat_kernels
+ * @return 	Conv1D_Stream
+ * @note	Each row of Mat_kernels is the kernel of one channel
+ * 
+ * This function creates a streaming 1D convolution state with a copy of the kernels
+ * and an empty (zero) history.
+ */
+Conv1D_Stream create_conv1d_stream(Matrix *Mat_kernels);
+
+/**
+ * @brief	Reset streaming 1D convolution
+ * @param 	Stream
+ * @return 	None
+ * 
+ * This function clears the history, e.g. to start a new signal with the same kernels.
+ */
+void reset_conv1d_stream(Conv1D_Stream *Stream);
+
+/**
+ * @brief	Free streaming 1D convolution
+ * @param 	Stream
+ * @return 	None
+ */
+void free_conv1d_stream(Conv1D_Stream *Stream);
+
+/**
+ * @brief	Streaming 1D convolution on vector
+ * @param 	Stream
+ * @param 	Vec_In
+ * @return 	Vector
+ * @note	Stream must have a single channel
+ * 
+ * This function pushes the next chunk of a single-channel signal and return the
+ * output of the new samples only, i.e. a new vector with the same length as the chunk.\n
+ * See convolution_1d_stream_Mat_wCPU() for details.
+ */
+Vector convolution_1d_stream_Vec_wCPU(Conv1D_Stream *Stream, Vector *Vec_In);
+
+/**
+ * @brief	Streaming 1D convolution on matrix
+ * @param 	Stream
+ * @param 	Mat_In
+ * @return 	matrix
+ * @note	Matrix's row must be the same to the number of channels of the stream
+ * 
+ * This function pushes the next chunk of a multi-channel signal (one channel per row) 
+ * and return the output of the new samples only, i.e. a new matrix with the same 
+ * dimension as the chunk.\n
+ * Output sample t is the kernel applied to the len samples ending at input sample t, 
+ * using the stream history for samples older than the chunk. Concatenating the outputs
+ * of all chunks gives the valid convolution of the whole signal prefixed by len-1 zeros.
+ * Cost per chunk is proportional to chunk length times kernel length.
+ */
+Matrix convolution_1d_stream_Mat_wCPU(Conv1D_Stream *Stream, Matrix *Mat_In);
+
+/**
+ * @brief	2D convolution on tensor with a chosen algorithm
+ * @param 	Tsr_In
+ * @param 	Tsr_kernel
+ * @param 	stride
+ * @param	filter_size
+ * @param	algorithm
+ * @return 	Tensor
+ * @note	CONV_ALGO_POINTWISE requires a 1x1 kernel
+ * 
+ * This function computes the same result as convolution_2d_Tsr_wCPU() with the given algorithm.
+ */
+Tensor convolution_2d_algo_Tsr_wCPU(Tensor *Tsr_In, Tensor *Tsr_kernel, int stride, int filter_size, Conv_Algorithm algorithm);
+
+/**
+ * @brief	Find the fastest convolution algorithm for a convolution shape
+ * @param 	Tsr_In
+ * @param	padsize
+ * @param 	Tsr_kernel
+ * @param 	stride
+ * @param	filter_size
+ * @return 	Conv_Algorithm
+ * @note	The plan cache is not thread-safe, plan (or load plans) before running in parallel
+ * 
+ * This function returns the cached algorithm for (input shape, kernel shape, stride, padsize,
+ * filter size, number of threads). On first use of a shape, all applicable algorithms are 
+ * benchmarked on the given data, the fastest one is cached in memory and returned.\n
+ * There is no im2col + GEMM candidate: for kernels larger than 1x1 the choice is between
+ * the output-major and the kernel-tap-major loop order of the direct convolution.
+ */
+Conv_Algorithm convolution_2d_plan_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr_kernel, int stride, int filter_size);
+
+/**
+ * @brief	Autotuned 2D convolution on tensor
+ * @param 	Tsr_In
+ * @param	padsize
+ * @param 	Tsr_kernel
+ * @param 	stride
+ * @param	filter_size
+ * @return 	Tensor
+ * @note	
+ * 1. stride value must be more than 0
+ * 2. padsize of 0 performs valid convolution, the input tensor is not modified
+ * 
+ * This function performs 2D convolution using the algorithm chosen by 
+ * convolution_2d_plan_Tsr_wCPU(). The result is the same as convolution_2d_Tsr_wCPU()
+ * on the zero-padded input.
+ */
+Tensor convolution_2d_tuned_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr_kernel, int stride, int filter_size);
+
+/**
+ * @brief	Save convolution plans to file
+ * @param 	filename
+ * @return 	int
+ * 
+ * This function writes all cached convolution plans to a text file and return
+ * the number of plans written, or -1 if the file cannot be written.
+ */
+int save_conv_plans(const char *filename);
+
+/**
+ * @brief	Load convolution plans from file
+ * @param 	filename
+ * @return 	int
+ * 
+ * This function reads convolution plans written by save_conv_plans() into the plan cache, 
+ * so that later runs skip benchmarking, and return the number of plans loaded, 
+ * or -1 if the file cannot be read. Unknown or inapplicable algorithms are ignored.
+ */
+int load_conv_plans(const char *filename);
+
+/**
+ * @brief	Clear convolution plans
+ * @return 	None
+ * 
+ * This function empties the in-memory plan cache.
+ */
+void clear_conv_plans(void);
+
+/**
+ * @brief	Separate a 2D kernel into column and row kernels
+ * @param 	Mat_kernel
+ * @param 	Vec_col_kernel
+ * @param 	Vec_row_kernel
+ * @param 	tolerance
+ * @return 	int
+ * @note	Vec_col_kernel and Vec_row_kernel are only created when the function returns 1
+ * 
+ * This function checks whether the kernel is separable (rank-1), i.e. 
+ * kernel[m][n] = col[m] * row[n] for all elements within tolerance times the largest 
+ * absolute kernel value. If so, it creates both 1D kernels and return 1, otherwise return 0.\n
+ * Gaussian, box and Sobel kernels are separable.
+ */
+int separate_kernel_Mat_wCPU(Matrix *Mat_kernel, Vector *Vec_col_kernel, Vector *Vec_row_kernel, float tolerance);
+
+/**
+ * @brief	Separable 2D convolution on matrix
+ * @param 	Mat_In
+ * @param 	Vec_col_kernel
+ * @param 	Vec_row_kernel
+ * @param 	stride
+ * @return 	matrix
+ * @note	stride value must be more than 0
+ * 
+ * This function performs 2D valid convolution with the kernel col[m] * row[n] as a row pass
+ * followed by a column pass, i.e. 2k instead of k*k multiplications per output element 
+ * for a k x k kernel. The result is the same as convolution_2d_Mat_wCPU() with the full kernel.\n
+ * Only the last few row-pass results are kept, no full-size intermediate matrix is created.
+ */
+Matrix convolution_2d_separable_Mat_wCPU(Matrix *Mat_In, Vector *Vec_col_kernel, Vector *Vec_row_kernel, int stride);
+
+/**
+ * @brief	2D convolution with border mode on matrix
+ * @param 	Mat_In
+ * @param	padsize
+ * @param 	Mat_kernel
+ * @param 	stride
+ * @param	mode
+ * @param	value
+ * @return 	matrix
+ * @note	stride value must be more than 0, padsize value must not be negative
+ * 
+ * This function performs 2D convolution on the input matrix extended by padsize elements
+ * on every side, where the extension is resolved by the border mode (value is the
+ * constant used by BORDER_CONSTANT).\n
+ * Borders are resolved on the fly, the input matrix is neither modified nor copied.
+ * BORDER_CONSTANT with value 0 gives the same result as convolution_2d_with_pad_Mat_wCPU().
+ */
+Matrix convolution_2d_with_border_Mat_wCPU(Matrix *Mat_In, int padsize, Matrix *Mat_kernel, int stride, Border_Mode mode, float value);
+
+/**
+ * @brief	2D convolution with border mode on tensor
+ * @param 	Tsr_In
+ * @param	padsize
+ * @param 	Tsr_kernel
+ * @param 	stride
+ * @param	filter_size
+ * @param	mode
+ * @param	value
+ * @return 	Tensor
+ * @note	stride value must be more than 0, padsize value must not be negative
+ * 
+ * This function performs 2D convolution on the input tensor extended by padsize elements
+ * on every side of each layer, where the extension is resolved by the border mode 
+ * (value is the constant used by BORDER_CONSTANT), and return a new tensor based on the
+ * specified filter size.\n
+ * Borders are resolved on the fly, the input tensor is neither modified nor copied.
+ */
+Tensor convolution_2d_with_border_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr_kernel, int stride, int filter_size, Border_Mode mode, float value);
+
+/**
+ * @brief	Fold batch normalization into convolution kernels and bias
+ * @param 	Tsr_kernels
+ * @param 	Vec_Bias
+ * @param	filter_size
+ * @param 	Vec_Gamma
+ * @param 	Vec_Beta
+ * @param 	Vec_Mean
+ * @param 	Vec_Var
+ * @param 	eps
+ * @return 	None
+ * @note	
+ * 1. Tsr_kernels is an array of filter_size kernels, as used by convolution_2d_grouped_Tsr_wCPU(),
+ * convolution_2d_relu_maxpool_Tsr_wCPU() and convolution_2d_transposed_Tsr_wCPU()
+ * 2. Vec_Bias is required and its length must be filter_size; a convolution without bias
+ * folds into a zero bias vector
+ * 3. Batch normalization parameters are as in batchnorm_Tsr_wCPU(), one per filter
+ * 
+ * This function is meant to run once when the model is loaded. It rewrites the kernels and
+ * bias in place so that the convolution alone computes batchnorm_Tsr_wCPU() of the original
+ * convolution output, i.e. kernel k is scaled by gamma[k]/sqrt(var[k] + eps) and bias k
+ * becomes (bias[k] - mean[k])*scale + beta[k]. Inference then pays nothing for the batch
+ * normalization layer.
+ */
+void fold_batchnorm_conv_wCPU(Tensor *Tsr_kernels, Vector *Vec_Bias, int filter_size, Vector *Vec_Gamma, Vector *Vec_Beta, 
+							  Vector *Vec_Mean, Vector *Vec_Var, float eps);
+
 #endif /* CONVOLUTION_H */
@@ -34,84 +34,257 @@
  * @todo 
  * 1. parallelism
  * 
+ * The flatten_* and reshape_* functions return views sharing the input buffer when the
+ * input storage is contiguous (always the case for objects from create_*), so
+ * flattening before a fully-connected layer or reshaping between layers costs only
+ * the row pointer tables. Views are marked in the object, so free_vector(),
+ * free_matrix() and free_tensor() release views and copies alike.
+ * 
  * @bug No known bugs
  */
  
 #include "data_conversion.h"
 
-Vector Mat2Vec_wCPU(Matrix *Mat_In)
+// Copy the elements of a matrix or tensor, in row-major (layer-major) order, to a
+// contiguous buffer one row at a time
+static void gather_Mat(Matrix *Mat_In, float *dst)
 {
-    int templen = Mat_In->row * Mat_In->col;  
-    
-    Vector tempVec = create_vector(templen);  
-     
-    for (int idx = 0; idx < tempVec.len; idx++)
-    {  
-        int idxrow = idx / Mat_In->col;
-        int idxcol = idx % Mat_In->col;
-        
-        tempVec.vals[idx] = Mat_In->vals[idxrow][idxcol];
-    }   
-    
-    return tempVec;
+	for (int i = 0; i < Mat_In->row; i++)
+	{
+		memcpy(dst + (size_t)i * Mat_In->col, Mat_In->vals[i], Mat_In->col * sizeof(float));
+	}
 }
 
-Vector Tsr2Vec_wCPU(Tensor *Tsr_In)
+static void gather_Tsr(Tensor *Tsr_In, float *dst)
+{
+	for (int k = 0; k < Tsr_In->depth; k++)
+	{
+		for (int i = 0; i < Tsr_In->row; i++)
+		{
+			memcpy(dst + ((size_t)k * Tsr_In->row + i) * Tsr_In->col, Tsr_In->vals[k][i], Tsr_In->col * sizeof(float));
+		}
+	}
+}
+
+// Start of the data block of a contiguous matrix or tensor, NULL when it has no rows
+static float *data_Mat(Matrix *Mat_In)
+{
+	return (Mat_In->row > 0) ? Mat_In->vals[0] : NULL;
+}
+
+static float *data_Tsr(Tensor *Tsr_In)
 {
-	int templen = Tsr_In->row * Tsr_In->col * Tsr_In->depth;
+	return (Tsr_In->depth > 0 && Tsr_In->row > 0) ? Tsr_In->vals[0][0] : NULL;
+}
+
+// Matrix or tensor whose row pointers index into an existing buffer, laid out as
+// create_matrix() and create_tensor() do; only the pointer tables are allocated
+static Matrix matrix_view(float *data, int Mat_Row, int Mat_Col)
+{
+	Matrix tempMat;
 	
-	Vector tempVec = create_vector(templen);
+	tempMat.row = Mat_Row;
+	tempMat.col = Mat_Col;
+	tempMat.view = 1;
+	tempMat.vals = malloc((Mat_Row > 0 ? Mat_Row : 1) * sizeof(float *));
 	
-	for (int idx = 0; idx < tempVec.len; idx++)
+	for (int i = 0; i < Mat_Row; i++)
 	{
-		int idxdepth = idx / (Tsr_In->row * Tsr_In->col);
-		int idxrow = (idx / Tsr_In->col) % Tsr_In->row;
-		int idxcol = idx % Tsr_In->col;
+		tempMat.vals[i] = data + (size_t)i * Mat_Col;
+	}
+	
+	return tempMat;
+}
+
+static Tensor tensor_view(float *data, int Tsr_Row, int Tsr_Col, int Tsr_Depth)
+{
+	Tensor tempTsr;
+	
+	tempTsr.row = Tsr_Row;
+	tempTsr.col = Tsr_Col;
+	tempTsr.depth = Tsr_Depth;
+	tempTsr.view = 1;
+	tempTsr.vals = calloc((Tsr_Depth > 0 ? Tsr_Depth : 1), sizeof(float **));
+	
+	if (Tsr_Depth > 0 && Tsr_Row > 0)
+	{
+		float **rows = malloc((size_t)Tsr_Depth * Tsr_Row * sizeof(float *));
 		
-		tempVec.vals[idx] = Tsr_In->vals[idxdepth][idxrow][idxcol];
+		for (int k = 0; k < Tsr_Depth; k++)
+		{
+			tempTsr.vals[k] = rows + (size_t)k * Tsr_Row;
+			
+			for (int i = 0; i < Tsr_Row; i++)
+			{
+				tempTsr.vals[k][i] = data + ((size_t)k * Tsr_Row + i) * Tsr_Col;
+			}
+		}
 	}
 	
+	return tempTsr;
+}
+
+Vector Mat2Vec_wCPU(Matrix *Mat_In)
+{
+	Vector tempVec = create_vector(Mat_In->row * Mat_In->col);
+	
+	gather_Mat(Mat_In, tempVec.vals);
+	
+	return tempVec;
+}
+
+Vector Tsr2Vec_wCPU(Tensor *Tsr_In)
+{
+	Vector tempVec = create_vector(Tsr_In->row * Tsr_In->col * Tsr_In->depth);
+	
+	gather_Tsr(Tsr_In, tempVec.vals);
+	
 	return tempVec;
 }
 
 Matrix Vec2Mat_wCPU(Vector *Vec_In, int Mat_Row, int Mat_Col)
 {
+	assert(Vec_In->len == Mat_Row * Mat_Col);
+	
 	Matrix tempMat = create_matrix(Mat_Row, Mat_Col);
-
-	int idx = 0;   
-    
-    for(int i = 0; i < tempMat.row; i++)
-    {
-        for(int j = 0; j < tempMat.col; j++)
-        {          
-			tempMat.vals[i][j] = Vec_In->vals[idx];
-            
-            idx++;
-        }
-    }
-	   
-    return tempMat;   
+	
+	if (Mat_Row > 0)
+	{
+		memcpy(tempMat.vals[0], Vec_In->vals, Vec_In->len * sizeof(float));
+	}
+	
+	return tempMat;
 }
 
 Tensor Vec2Tsr_wCPU(Vector *Vec_In, int Tsr_Row, int Tsr_Col, int Tsr_Depth)
 {
-	Tensor tempTsr = create_tensor(Tsr_Row, Tsr_Col, Tsr_Depth);
+	assert(Vec_In->len == Tsr_Row * Tsr_Col * Tsr_Depth);
 	
-	int idx = 0;
+	Tensor tempTsr = create_tensor(Tsr_Row, Tsr_Col, Tsr_Depth);
 	
-	for(int k = 0; k < tempTsr.depth; k++)
+	if (Tsr_Depth > 0 && Tsr_Row > 0)
 	{
-		for(int i = 0; i < tempTsr.row; i++)
-		{
-			for(int j = 0; j < tempTsr.col; j++)
-			{
-				tempTsr.vals[k][i][j] = Vec_In->vals[idx];
-				
-				idx++;
-			}
-		}
+		memcpy(tempTsr.vals[0][0], Vec_In->vals, Vec_In->len * sizeof(float));
 	}
 	
 	return tempTsr;
 }
 
+int flatten_Mat_wCPU(Matrix *Mat_In, Vector *Vec_Out)
+{
+	if (is_contiguous_Mat(Mat_In))
+	{
+		Vec_Out->len = Mat_In->row * Mat_In->col;
+		Vec_Out->vals = data_Mat(Mat_In);
+		Vec_Out->view = 1;
+		
+		return 1;
+	}
+	
+	*Vec_Out = Mat2Vec_wCPU(Mat_In);
+	
+	return 0;
+}
+
+int flatten_Tsr_wCPU(Tensor *Tsr_In, Vector *Vec_Out)
+{
+	if (is_contiguous_Tsr(Tsr_In))
+	{
+		Vec_Out->len = Tsr_In->row * Tsr_In->col * Tsr_In->depth;
+		Vec_Out->vals = data_Tsr(Tsr_In);
+		Vec_Out->view = 1;
+		
+		return 1;
+	}
+	
+	*Vec_Out = Tsr2Vec_wCPU(Tsr_In);
+	
+	return 0;
+}
+
+int reshape_Vec2Mat_wCPU(Vector *Vec_In, int Mat_Row, int Mat_Col, Matrix *Mat_Out)
+{
+	assert(Vec_In->len == Mat_Row * Mat_Col);
+	
+	// A vector is always one block
+	*Mat_Out = matrix_view(Vec_In->vals, Mat_Row, Mat_Col);
+	
+	return 1;
+}
+
+int reshape_Vec2Tsr_wCPU(Vector *Vec_In, int Tsr_Row, int Tsr_Col, int Tsr_Depth, Tensor *Tsr_Out)
+{
+	assert(Vec_In->len == Tsr_Row * Tsr_Col * Tsr_Depth);
+	
+	*Tsr_Out = tensor_view(Vec_In->vals, Tsr_Row, Tsr_Col, Tsr_Depth);
+	
+	return 1;
+}
+
+int reshape_Mat_wCPU(Matrix *Mat_In, int Mat_Row, int Mat_Col, Matrix *Mat_Out)
+{
+	assert(Mat_In->row * Mat_In->col == Mat_Row * Mat_Col);
+	
+	if (is_contiguous_Mat(Mat_In))
+	{
+		*Mat_Out = matrix_view(data_Mat(Mat_In), Mat_Row, Mat_Col);
+		
+		return 1;
+	}
+	
+	*Mat_Out = create_matrix(Mat_Row, Mat_Col);
+	gather_Mat(Mat_In, data_Mat(Mat_Out));
+	
+	return 0;
+}
+
+int reshape_Tsr_wCPU(Tensor *Tsr_In, int Tsr_Row, int Tsr_Col, int Tsr_Depth, Tensor *Tsr_Out)
+{
+	assert(Tsr_In->row * Tsr_In->col * Tsr_In->depth == Tsr_Row * Tsr_Col * Tsr_Depth);
+	
+	if (is_contiguous_Tsr(Tsr_In))
+	{
+		*Tsr_Out = tensor_view(data_Tsr(Tsr_In), Tsr_Row, Tsr_Col, Tsr_Depth);
+		
+		return 1;
+	}
+	
+	*Tsr_Out = create_tensor(Tsr_Row, Tsr_Col, Tsr_Depth);
+	gather_Tsr(Tsr_In, data_Tsr(Tsr_Out));
+	
+	return 0;
+}
+
+int reshape_Tsr2Mat_wCPU(Tensor *Tsr_In, int Mat_Row, int Mat_Col, Matrix *Mat_Out)
+{
+	assert(Tsr_In->row * Tsr_In->col * Tsr_In->depth == Mat_Row * Mat_Col);
+	
+	if (is_contiguous_Tsr(Tsr_In))
+	{
+		*Mat_Out = matrix_view(data_Tsr(Tsr_In), Mat_Row, Mat_Col);
+		
+		return 1;
+	}
+	
+	*Mat_Out = create_matrix(Mat_Row, Mat_Col);
+	gather_Tsr(Tsr_In, data_Mat(Mat_Out));
+	
+	return 0;
+}
+
+int reshape_Mat2Tsr_wCPU(Matrix *Mat_In, int Tsr_Row, int Tsr_Col, int Tsr_Depth, Tensor *Tsr_Out)
+{
+	assert(Mat_In->row * Mat_In->col == Tsr_Row * Tsr_Col * Tsr_Depth);
+	
+	if (is_contiguous_Mat(Mat_In))
+	{
+		*Tsr_Out = tensor_view(data_Mat(Mat_In), Tsr_Row, Tsr_Col, Tsr_Depth);
+		
+		return 1;
+	}
+	
+	*Tsr_Out = create_tensor(Tsr_Row, Tsr_Col, Tsr_Depth);
+	gather_Mat(Mat_In, data_Tsr(Tsr_Out));
+	
+	return 0;
+}
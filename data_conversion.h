@@ -44,6 +44,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
+#include <string.h>
 
 #include "vector.h"
 #include "matrix.h"
@@ -54,7 +55,8 @@
  * @param 	Mat_In
  * @return 	Vector
  * 
- * This function converts matrix to vector
+ * This function converts matrix to vector, copying the elements.
+ * See flatten_Mat_wCPU() for a version without copy.
  */
 Vector Mat2Vec_wCPU(Matrix *Mat_In);
 
@@ -63,7 +65,8 @@ Vector Mat2Vec_wCPU(Matrix *Mat_In);
  * @param 	Tsr_In
  * @return 	Vector
  * 
- * This function converts tensor to vector
+ * This function converts tensor to vector, copying the elements.
+ * See flatten_Tsr_wCPU() for a version without copy.
  */
 Vector Tsr2Vec_wCPU(Tensor *Tsr_In);
 
@@ -75,21 +78,147 @@ Vector Tsr2Vec_wCPU(Tensor *Tsr_In);
  * @return 	matrix
  * @note	vector's length must be the same to matrix's row*col
  * 
- * This function converts vector to matrix
+ * This function converts vector to matrix, copying the elements.
+ * See reshape_Vec2Mat_wCPU() for a version without copy.
  */
 Matrix Vec2Mat_wCPU(Vector *Vec_In, int Mat_Row, int Mat_Col);
 
 /**
- * @brief	Convert tensor to vector
+ * @brief	Convert vector to tensor
  * @param 	Vec_In
  * @param	Tsr_Row
  * @param	Tsr_Col
  * @param	Tsr_Depth
- * @return 	Vector
+ * @return 	Tensor
  * @note	vector's length must be the same to tensor's row*col*depth
  * 
- * This function converts tensor to vector
+ * This function converts vector to tensor, copying the elements.
+ * See reshape_Vec2Tsr_wCPU() for a version without copy.
  */
 Tensor Vec2Tsr_wCPU(Vector *Vec_In, int Tsr_Row, int Tsr_Col, int Tsr_Depth);
 
+/**
+ * @brief	Flatten matrix to vector
+ * @param 	Mat_In
+ * @param 	Vec_Out
+ * @return 	int
+ * @note	
+ * 1. Returns 1 if Vec_Out is a view sharing the buffer of Mat_In, 0 if it is a copy
+ * 2. A view is only valid while Mat_In is; free either with free_vector(), which leaves a view's values to Mat_In
+ * 
+ * This function gives the elements of the matrix in row-major order as a vector.
+ * A contiguous matrix is flattened without copy, otherwise its rows are copied.
+ */
+int flatten_Mat_wCPU(Matrix *Mat_In, Vector *Vec_Out);
+
+/**
+ * @brief	Flatten tensor to vector
+ * @param 	Tsr_In
+ * @param 	Vec_Out
+ * @return 	int
+ * @note	
+ * 1. Returns 1 if Vec_Out is a view sharing the buffer of Tsr_In, 0 if it is a copy
+ * 2. A view is only valid while Tsr_In is; free either with free_vector(), which leaves a view's values to Tsr_In
+ * 
+ * This function gives the elements of the tensor in layer-major order as a vector.
+ * A contiguous tensor is flattened without copy, otherwise its rows are copied.
+ */
+int flatten_Tsr_wCPU(Tensor *Tsr_In, Vector *Vec_Out);
+
+/**
+ * @brief	Reshape vector to matrix
+ * @param 	Vec_In
+ * @param	Mat_Row
+ * @param	Mat_Col
+ * @param 	Mat_Out
+ * @return 	int
+ * @note	
+ * 1. vector's length must be the same to matrix's row*col
+ * 2. Always returns 1: Mat_Out is a view sharing the buffer of Vec_In, free it with free_matrix()
+ * 
+ * This function views the vector as a matrix; only the row pointers are allocated.
+ */
+int reshape_Vec2Mat_wCPU(Vector *Vec_In, int Mat_Row, int Mat_Col, Matrix *Mat_Out);
+
+/**
+ * @brief	Reshape vector to tensor
+ * @param 	Vec_In
+ * @param	Tsr_Row
+ * @param	Tsr_Col
+ * @param	Tsr_Depth
+ * @param 	Tsr_Out
+ * @return 	int
+ * @note	
+ * 1. vector's length must be the same to tensor's row*col*depth
+ * 2. Always returns 1: Tsr_Out is a view sharing the buffer of Vec_In, free it with free_tensor()
+ * 
+ * This function views the vector as a tensor; only the row pointers are allocated.
+ */
+int reshape_Vec2Tsr_wCPU(Vector *Vec_In, int Tsr_Row, int Tsr_Col, int Tsr_Depth, Tensor *Tsr_Out);
+
+/**
+ * @brief	Reshape matrix
+ * @param 	Mat_In
+ * @param	Mat_Row
+ * @param	Mat_Col
+ * @param 	Mat_Out
+ * @return 	int
+ * @note	
+ * 1. Number of elements must be the same
+ * 2. Returns 1 if Mat_Out is a view, 0 if a copy; free either with free_matrix()
+ * 
+ * This function gives the matrix with a new shape, elements kept in row-major order.
+ * A contiguous matrix is reshaped without copy.
+ */
+int reshape_Mat_wCPU(Matrix *Mat_In, int Mat_Row, int Mat_Col, Matrix *Mat_Out);
+
+/**
+ * @brief	Reshape tensor
+ * @param 	Tsr_In
+ * @param	Tsr_Row
+ * @param	Tsr_Col
+ * @param	Tsr_Depth
+ * @param 	Tsr_Out
+ * @return 	int
+ * @note	
+ * 1. Number of elements must be the same
+ * 2. Returns 1 if Tsr_Out is a view, 0 if a copy; free either with free_tensor()
+ * 
+ * This function gives the tensor with a new shape, elements kept in layer-major order.
+ * A contiguous tensor is reshaped without copy.
+ */
+int reshape_Tsr_wCPU(Tensor *Tsr_In, int Tsr_Row, int Tsr_Col, int Tsr_Depth, Tensor *Tsr_Out);
+
+/**
+ * @brief	Reshape tensor to matrix
+ * @param 	Tsr_In
+ * @param	Mat_Row
+ * @param	Mat_Col
+ * @param 	Mat_Out
+ * @return 	int
+ * @note	
+ * 1. Number of elements must be the same
+ * 2. Returns 1 if Mat_Out is a view, 0 if a copy; free either with free_matrix()
+ * 
+ * This function gives the tensor as a matrix, e.g. depth x (row*col) for channel-wise GEMM.
+ * A contiguous tensor is reshaped without copy.
+ */
+int reshape_Tsr2Mat_wCPU(Tensor *Tsr_In, int Mat_Row, int Mat_Col, Matrix *Mat_Out);
+
+/**
+ * @brief	Reshape matrix to tensor
+ * @param 	Mat_In
+ * @param	Tsr_Row
+ * @param	Tsr_Col
+ * @param	Tsr_Depth
+ * @param 	Tsr_Out
+ * @return 	int
+ * @note	
+ * 1. Number of elements must be the same
+ * 2. Returns 1 if Tsr_Out is a view, 0 if a copy; free either with free_tensor()
+ * 
+ * This function gives the matrix as a tensor. A contiguous matrix is reshaped without copy.
+ */
+int reshape_Mat2Tsr_wCPU(Matrix *Mat_In, int Tsr_Row, int Tsr_Col, int Tsr_Depth, Tensor *Tsr_Out);
+
 #endif /* DATA_CONVERSION_H */
@@ -0,0 +1,199 @@
+/****************************************************************************
+ *                                                                          *
+ * 	DeepC: Deep Learning/Machine Learning Inference Library written in C 	*
+ * 																			*
+ * 	Copyright (C) 2018 by Andriyanto Halim          						*
+ *                                                                          *
+ *  This program is free software: you can redistribute it and/or modify	*
+ *  it under the terms of the GNU General Public License as published by	*
+ *  the Free Software Foundation, either version 3 of the License, or		*
+ *  (at your option) any later version.										*
+ *                                                                          *
+ *  This program is distributed in the hope that it will be useful,        	*
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of        	*
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          	*
+ *  GNU Lesser General Public License for more details.                    	*
+ *                                                                         	*
+ *  You should have received a copy of the GNU Lesser General Public       	*
+ *  License along with this program. If not, see							*
+ *  <http://www.gnu.org/licenses/>. 										*
+ * 																			*
+ ****************************************************************************/
+  
+/**
+ * @file internal.h
+ * @brief Helpers shared by the library's source files
+ *
+ * This header is included by .c files only and is not part of the public interface.
+ * 
+ * @author Andriyanto Halim
+ * @date 16 May 2018
+ * 
+ * @bug No known bugs
+ */
+ 
+#ifndef INTERNAL_H
+#define INTERNAL_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "vector.h"
+#include "matrix.h"
+#include "tensor.h"
+
+// Pick a if cond is set, b otherwise, through the bit patterns: unlike a ternary on
+// floats this is never turned back into a branch, which would block vectorization
+static inline float select_float(int cond, float a, float b)
+{
+	union { int32_t i; float f; } ua, ub;
+	
+	int32_t mask = -cond;
+	
+	ua.f = a;
+	ub.f = b;
+	ua.i = (ua.i & mask) | (ub.i & ~mask);
+	
+	return ua.f;
+}
+
+// Whole-object reductions split the data into parts whatever the number of threads:
+// chunks of REDUCE_CHUNK elements of a contiguous block, or the rows of a matrix or 
+// tensor whose storage is not contiguous. Parts are reduced in parallel, each in 
+// REDUCE_LANES independent lanes, and the part partials are merged in a fixed pairwise
+// tree, so results are bitwise identical for any OMP_NUM_THREADS.
+#define REDUCE_CHUNK 65536
+#define REDUCE_LANES 32
+
+// Data of a whole-object reduction, a contiguous block or a list of equal rows
+typedef struct Reduce_Source
+{
+	const float *vals;		// contiguous block, NULL when the rows are used
+	float **rows;			// rows of rowlen elements otherwise
+	long count;				// number of elements
+	int rowlen;
+	int owns_rows;			// rows was allocated for a tensor
+} Reduce_Source;
+
+typedef void (*reduce_part_fn)(const void *ctx, long part, void *partial);
+typedef void (*reduce_merge_fn)(void *partial, const void *other);
+
+static inline Reduce_Source reduce_source_Vec(Vector *Vec_In)
+{
+	Reduce_Source tempSrc = {Vec_In->vals, NULL, Vec_In->len, Vec_In->len, 0};
+	
+	return tempSrc;
+}
+
+// The contiguous block is used when flat is set and the storage allows it
+static inline Reduce_Source reduce_source_Mat(Matrix *Mat_In, int flat)
+{
+	Reduce_Source tempSrc = {NULL, Mat_In->vals, (long)Mat_In->row*Mat_In->col, Mat_In->col, 0};
+	
+	if (tempSrc.count > 0 && flat && is_contiguous_Mat(Mat_In))
+	{
+		tempSrc.vals = Mat_In->vals[0];
+	}
+	
+	return tempSrc;
+}
+
+static inline Reduce_Source reduce_source_Tsr(Tensor *Tsr_In, int flat)
+{
+	Reduce_Source tempSrc = {NULL, NULL, (long)Tsr_In->depth*Tsr_In->row*Tsr_In->col, Tsr_In->col, 0};
+	
+	if (tempSrc.count == 0)
+	{
+		return tempSrc;
+	}
+	
+	if (flat && is_contiguous_Tsr(Tsr_In))
+	{
+		tempSrc.vals = Tsr_In->vals[0][0];
+		
+		return tempSrc;
+	}
+	
+	tempSrc.rows = malloc((size_t)Tsr_In->depth*Tsr_In->row*sizeof(float *));
+	assert(tempSrc.rows != NULL);
+	tempSrc.owns_rows = 1;
+	
+	for (int k = 0; k < Tsr_In->depth; k++)
+	{
+		memcpy(tempSrc.rows + (size_t)k*Tsr_In->row, Tsr_In->vals[k], Tsr_In->row*sizeof(float *));
+	}
+	
+	return tempSrc;
+}
+
+static inline void free_reduce_source(Reduce_Source *Src)
+{
+	if (Src->owns_rows)
+	{
+		free(Src->rows);
+	}
+	
+	Src->rows = NULL;
+	Src->owns_rows = 0;
+}
+
+static inline long reduce_parts(const Reduce_Source *Src)
+{
+	if (Src->count == 0)
+	{
+		return 0;
+	}
+	
+	return (Src->vals != NULL) ? (Src->count + REDUCE_CHUNK - 1)/REDUCE_CHUNK : Src->count/Src->rowlen;
+}
+
+// Start and length of one part
+static inline const float *reduce_part(const Reduce_Source *Src, long part, int *len)
+{
+	if (Src->vals == NULL)
+	{
+		*len = Src->rowlen;
+		
+		return Src->rows[part];
+	}
+	
+	long rest = Src->count - part*REDUCE_CHUNK;
+	*len = (int)(rest < REDUCE_CHUNK ? rest : REDUCE_CHUNK);
+	
+	return Src->vals + part*REDUCE_CHUNK;
+}
+
+// Reduce parts [0, nparts) in parallel with partfn into partials of size bytes and merge
+// them pairwise in a fixed tree into result, which is left as it is when there are none
+static inline void reduce_tree(long nparts, size_t size, reduce_part_fn partfn, reduce_merge_fn mergefn,
+							   const void *ctx, void *result)
+{
+	if (nparts == 0)
+	{
+		return;
+	}
+	
+	char *partial = malloc(nparts*size);
+	assert(partial != NULL);
+	
+	#pragma omp parallel for
+	for (long c = 0; c < nparts; c++)
+	{
+		partfn(ctx, c, partial + c*size);
+	}
+	
+	for (long stride = 1; stride < nparts; stride *= 2)
+	{
+		for (long c = 0; c + stride < nparts; c += 2*stride)
+		{
+			mergefn(partial + c*size, partial + (c + stride)*size);
+		}
+	}
+	
+	memcpy(result, partial, size);
+	free(partial);
+}
+
+#endif /* INTERNAL_H */
@@ -98,7 +98,17 @@
  * \section Compilation
  * Open the terminal and run following command:
  * @code
- * gcc *.c -std=c99 -o main -lm && ./main
+ * gcc *.c -std=c99 -fopenmp -o main -lm && ./main
+ * @endcode
+ * -fopenmp is required: the library parallelizes its loops with OpenMP pragmas.
+ * Add -O3 to let the compiler vectorize the inner loops:
+ * @code
+ * gcc *.c -std=c99 -O3 -fopenmp -o main -lm && ./main
+ * @endcode
+ * A single-threaded build without OpenMP still works (the pragmas are ignored), but the
+ * compiler warns about them under -Wall unless -Wno-unknown-pragmas is given:
+ * @code
+ * gcc *.c -std=c99 -Wall -Wno-unknown-pragmas -o main -lm && ./main
  * @endcode
  *
  * \section Todo-lists
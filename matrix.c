@@ -45,12 +45,19 @@ Matrix create_matrix(int Mat_Row, int Mat_Col)
     
     M.row = Mat_Row;
     M.col = Mat_Col;
+    M.view = 0;
     
     M.vals = calloc(M.row, sizeof(float *));
     
-    for(int j = 0; j < M.row; j++)
+    // Rows point into one contiguous row-major block owned by vals[0]
+    if (M.row > 0)
     {
-        M.vals[j] = calloc(M.col, sizeof(float));
+        M.vals[0] = calloc((size_t)M.row * M.col, sizeof(float));
+        
+        for(int j = 1; j < M.row; j++)
+        {
+            M.vals[j] = M.vals[0] + (size_t)j * M.col;
+        }
     }
     
     return M;
@@ -125,9 +132,10 @@ void print_matrix_dim(Matrix *Mat)
 
 void free_matrix(Matrix *Mat)
 {
-    for(int i = 0; i < Mat->row; i++)
+    // A view owns its row pointers only, the values belong to its parent
+    if (Mat->row > 0 && !Mat->view)
     {
-        free(Mat->vals[i]);
+        free(Mat->vals[0]);
     }
     
     free(Mat->vals);
@@ -163,3 +171,16 @@ Matrix transpose_Mat_wCPU(Matrix *Mat_In)
     return tempMat;
 }
 
+int is_contiguous_Mat(Matrix *Mat)
+{
+    // Rows must follow each other in one block, as laid out by create_matrix
+    for (int i = 1; i < Mat->row; i++)
+    {
+        if (Mat->vals[i] != Mat->vals[0] + (size_t)i * Mat->col)
+        {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
@@ -53,13 +53,17 @@
 /**
  * @brief Define Matrix
  *
- * Define Matrix data structure
+ * Define Matrix data structure.\n
+ * Matrices from create_matrix() are stored row-major in one contiguous block:
+ * vals[0] is the start of the block and vals[i] == vals[0] + i*col.
+ * A view (view != 0) owns its row pointers only, free_matrix() leaves the values as is.
  * 
  */
 typedef struct Matrix
 {
     int row, col;
     float **vals;
+    int view;
 } Matrix;
 
 
@@ -72,5 +76,6 @@ void print_matrix_dim(Matrix *Mat);
 void free_matrix(Matrix *Mat);
 Matrix copy_Mat_wCPU(Matrix *Mat_In);
 Matrix transpose_Mat_wCPU(Matrix *Mat_In);
+int is_contiguous_Mat(Matrix *Mat);
 
 #endif /* MATRIX_H */
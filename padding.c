@@ -46,6 +46,45 @@
  
 #include "padding.h"
 
+// Write one zero-padded layer into a preallocated destination: borders are cleared
+// with memset and each input row is moved with a single memcpy
+static void padding_2d_layer(float **invals, int inrow, int incol, float **outvals, int top, int left, int bottom, int right)
+{
+	int tempcol = left + incol + right;
+	
+	for (int i = 0; i < top; i++)
+	{
+		memset(outvals[i], 0, tempcol * sizeof(float));
+	}
+	
+	for (int i = 0; i < inrow; i++)
+	{
+		float *outrow = outvals[i + top];
+		
+		memset(outrow, 0, left * sizeof(float));
+		memcpy(outrow + left, invals[i], incol * sizeof(float));
+		memset(outrow + left + incol, 0, right * sizeof(float));
+	}
+	
+	for (int i = inrow + top; i < inrow + top + bottom; i++)
+	{
+		memset(outvals[i], 0, tempcol * sizeof(float));
+	}
+}
+
+static void padding_2d_layers(Tensor *Tsr_In, Tensor *Tsr_Out, int top, int left, int bottom, int right)
+{
+	assert(Tsr_Out->depth == Tsr_In->depth);
+	assert(Tsr_Out->row == Tsr_In->row + top + bottom);
+	assert(Tsr_Out->col == Tsr_In->col + left + right);
+	
+	#pragma omp parallel for
+	for (int k = 0; k < Tsr_In->depth; k++)
+	{
+		padding_2d_layer(Tsr_In->vals[k], Tsr_In->row, Tsr_In->col, Tsr_Out->vals[k], top, left, bottom, right);
+	}
+}
+
 Vector padding_asymmetric_Vec_wCPU(Vector *Vec_In, int padsize)
 {
 	assert(padsize > 0);
@@ -54,10 +93,7 @@ Vector padding_asymmetric_Vec_wCPU(Vector *Vec_In, int padsize)
 	
 	Vector tempVec = create_vector(templen);
 	
-	for (int i = 0; i < Vec_In->len; i++)
-	{
-		tempVec.vals[i] = Vec_In->vals[i];
-	}
+	memcpy(tempVec.vals, Vec_In->vals, Vec_In->len * sizeof(float));
 	
 	return tempVec;
 }
@@ -72,13 +108,7 @@ Matrix padding_2d_asymmetric_Mat_wCPU(Matrix *Mat_In, int row_padsize, int col_p
     
     Matrix tempMat = create_matrix(temprow, tempcol);
     
-    for (int i = 0; i < Mat_In->row; i++)
-    {
-        for (int j = 0; j < Mat_In->col; j++)
-        {
-            tempMat.vals[i][j] = Mat_In->vals[i][j];
-        }
-    }
+    padding_2d_layer(Mat_In->vals, Mat_In->row, Mat_In->col, tempMat.vals, 0, 0, row_padsize, col_padsize);
     
     return tempMat;
 }
@@ -93,16 +123,7 @@ Tensor padding_2d_asymmetric_Tsr_wCPU(Tensor *Tsr_In, int row_padsize, int col_p
     
     Tensor tempTsr = create_tensor(temprow, tempcol, Tsr_In->depth);
     
-    for (int k = 0; k < Tsr_In->depth; k++)
-    {
-		for (int i = 0; i < Tsr_In->row; i++)
-		{
-			for (int j = 0; j < Tsr_In->col; j++)
-			{
-				tempTsr.vals[i][j] = Tsr_In->vals[i][j];
-			}
-		}
-    }
+    padding_2d_layers(Tsr_In, &tempTsr, 0, 0, row_padsize, col_padsize);
     
     return tempTsr;
 }
@@ -111,9 +132,25 @@ void vpadding_asymmetric_Vec_wCPU(Vector *Vec_In, int padsize)
 {
 	assert(padsize > 0);
 	
+	int oldlen = Vec_In->len;
+	
 	Vec_In->len += padsize;
 	
-	Vec_In->vals = realloc(Vec_In->vals, Vec_In->len * sizeof(float));
+	// A view's values belong to its parent, so a view gets a padded copy of its own
+	float *tempVals = Vec_In->view ? malloc(Vec_In->len * sizeof(float))
+								   : realloc(Vec_In->vals, Vec_In->len * sizeof(float));
+	
+	assert(tempVals != NULL);
+	
+	if (Vec_In->view)
+	{
+		memcpy(tempVals, Vec_In->vals, oldlen * sizeof(float));
+	}
+	
+	Vec_In->vals = tempVals;
+	Vec_In->view = 0;
+	
+	memset(Vec_In->vals + oldlen, 0, padsize * sizeof(float));
 }
 
 void vpadding_2d_asymmetric_Mat_wCPU(Matrix *Mat_In, int row_padsize, int col_padsize)
@@ -121,16 +158,11 @@ void vpadding_2d_asymmetric_Mat_wCPU(Matrix *Mat_In, int row_padsize, int col_pa
 	assert(row_padsize > 0);
 	assert(col_padsize > 0);
 	
-	Mat_In->row += row_padsize;
-	Mat_In->col += col_padsize;
+	Matrix tempMat = padding_2d_asymmetric_Mat_wCPU(Mat_In, row_padsize, col_padsize);
 	
-	// create bigger matrix based on the row- and col- padsize
-	Mat_In->vals = realloc(Mat_In->vals, Mat_In->row * sizeof(float *));
+	free_matrix(Mat_In);
 	
-	for(int i = 0; i < Mat_In->row; i++)
-	{
-		Mat_In->vals[i] = realloc(Mat_In->vals[i], Mat_In->col * sizeof(float));
-	}
+	*Mat_In = tempMat;
 }
 
 void vpadding_2d_asymmetric_Tsr_wCPU(Tensor *Tsr_In, int row_padsize, int col_padsize)
@@ -138,20 +170,11 @@ void vpadding_2d_asymmetric_Tsr_wCPU(Tensor *Tsr_In, int row_padsize, int col_pa
 	assert(row_padsize > 0);
 	assert(col_padsize > 0);
 	
-	Tsr_In->row += row_padsize;
-	Tsr_In->col += col_padsize;
+	Tensor tempTsr = padding_2d_asymmetric_Tsr_wCPU(Tsr_In, row_padsize, col_padsize);
 	
-	for(int k = 0; k < Tsr_In->depth; k++)
-	{
-		// create bigger matrix based on the row- and col- padsize
-		Tsr_In->vals[k] = realloc(Tsr_In->vals[k], Tsr_In->row * sizeof(float *));
-
-		for(int i = 0; i < Tsr_In->row; i++)
-		{
-			Tsr_In->vals[k][i] = realloc(Tsr_In->vals[k][i], Tsr_In->col * sizeof(float));
-		}
+	free_tensor(Tsr_In);
 	
-	}
+	*Tsr_In = tempTsr;
 }
 
 Vector padding_2d_Vec_wCPU(Vector *Vec_In, int padsize)
@@ -162,10 +185,7 @@ Vector padding_2d_Vec_wCPU(Vector *Vec_In, int padsize)
 	
 	Vector tempVec = create_vector(templen);
 	
-	for (int i = 0; i < tempVec.len; i++)
-	{
-		tempVec.vals[i + padsize] = Vec_In->vals[i]; 
-	}
+	memcpy(tempVec.vals + padsize, Vec_In->vals, Vec_In->len * sizeof(float));
 	
 	return tempVec;
 	
@@ -180,13 +200,7 @@ Matrix padding_2d_Mat_wCPU(Matrix *Mat_In, int padsize)
     
     Matrix tempMat = create_matrix(temprow, tempcol);
     
-    for (int i = 0; i < Mat_In->row; i++)
-    {
-        for (int j = 0; j < Mat_In->col; j++)
-        {
-            tempMat.vals[i + padsize][j + padsize] = Mat_In->vals[i][j];
-        }
-    }
+    padding_2d_into_Mat_wCPU(Mat_In, padsize, &tempMat);
     
     return tempMat;
 }
@@ -200,112 +214,88 @@ Tensor padding_2d_Tsr_wCPU(Tensor *Tsr_In, int padsize)
     
     Tensor tempTsr = create_tensor(temprow, tempcol, Tsr_In->depth);
     
-    for (int k = 0; k < Tsr_In->depth; k++)
-    {
-		for (int i = 0; i < Tsr_In->row; i++)
-		{
-			for (int j = 0; j < Tsr_In->col; j++)
-			{
-				tempTsr.vals[k][i + padsize][j + padsize] = Tsr_In->vals[k][i][j];
-			}
-		}
-	}
+    padding_2d_into_Tsr_wCPU(Tsr_In, padsize, &tempTsr);
 
     return tempTsr;
 }
 
-void vpadding_2d_Mat_wCPU(Matrix *Mat_In, int padsize)
+void padding_2d_into_Mat_wCPU(Matrix *Mat_In, int padsize, Matrix *Mat_Out)
 {
-	assert(padsize > 0);
-	
-	int row_padsize = 2*padsize;
-    int col_padsize = 2*padsize;
-    
-    Mat_In->row += row_padsize;
-	Mat_In->col += col_padsize;
+	assert(padsize >= 0);
+	assert(Mat_Out->row == Mat_In->row + 2*padsize);
+	assert(Mat_Out->col == Mat_In->col + 2*padsize);
+	assert(Mat_Out->vals != Mat_In->vals);
 	
-	// create bigger matrix based on the row- and col- padsize
-	Mat_In->vals = realloc(Mat_In->vals, Mat_In->row * sizeof(float *));
+	padding_2d_layer(Mat_In->vals, Mat_In->row, Mat_In->col, Mat_Out->vals, padsize, padsize, padsize, padsize);
+}
+
+void padding_2d_into_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr_Out)
+{
+	assert(padsize >= 0);
+	assert(Tsr_Out->vals != Tsr_In->vals);
 	
-	for(int i = 0; i < Mat_In->row; i++)
-	{
-		Mat_In->vals[i] = realloc(Mat_In->vals[i], Mat_In->col * sizeof(float));
-	}
+	padding_2d_layers(Tsr_In, Tsr_Out, padsize, padsize, padsize, padsize);
+}
+
+void vpadding_2d_Mat_wCPU(Matrix *Mat_In, int padsize)
+{
+	assert(padsize > 0);
 	
-	// shift matrix values to the center
-	for (int i = Mat_In->row - row_padsize; i >= 0; i--)
-    {
-		for (int j = Mat_In->col - col_padsize; j >= 0; j--)
-		{
-			Mat_In->vals[i + padsize][j + padsize] = Mat_In->vals[i][j];
-		}
-	}
+	Matrix tempMat = padding_2d_Mat_wCPU(Mat_In, padsize);
 	
-	// clean up the top side rows by applying zero padding
-	for(int i = 0; i < padsize; i++)
-	{
-		for(int j = 0; j < Mat_In->col; j++)
-		{
-			Mat_In->vals[i][j] = 0.0f;
-		}
-	}
+	free_matrix(Mat_In);
 	
-	// clean up the left side columns by applying zero padding
-	for(int i = 0; i < Mat_In->row; i++)
-	{
-		for(int j = 0; j < padsize; j++)
-		{
-			Mat_In->vals[i][j] = 0.0f;
-		}
-	}
+	*Mat_In = tempMat;
 }
   
 void vpadding_2d_Tsr_wCPU(Tensor *Tsr_In, int padsize)
 {
 	assert(padsize > 0);
 	
-	int row_padsize = 2*padsize;
-    int col_padsize = 2*padsize;
-    
-    Tsr_In->row += row_padsize;
-	Tsr_In->col += col_padsize;
+	Tensor tempTsr = padding_2d_Tsr_wCPU(Tsr_In, padsize);
 	
-	for (int k = 0; k < Tsr_In->depth; k++)
+	free_tensor(Tsr_In);
+	
+	*Tsr_In = tempTsr;
+}
+
+int border_index(int idx, int len, Border_Mode mode)
+{
+	if (idx >= 0 && idx < len)
 	{
-		// create bigger matrix at each layer based on the row- and col- padsize
-		Tsr_In->vals[k] = realloc(Tsr_In->vals[k], Tsr_In->row * sizeof(float *));
-		
-		for(int i = 0; i < Tsr_In->row; i++)
-		{
-			Tsr_In->vals[k][i] = realloc(Tsr_In->vals[k][i], Tsr_In->col * sizeof(float));
-		}
-		
-		// shift matrix values to the center
-		for (int i = Tsr_In->row - row_padsize; i >= 0; i--)
+		return idx;
+	}
+	
+	switch (mode)
+	{
+		case BORDER_REFLECT:
 		{
-			for (int j = Tsr_In->col - col_padsize; j >= 0; j--)
+			if (len == 1)
 			{
-				Tsr_In->vals[k][i + padsize][j + padsize] = Tsr_In->vals[k][i][j];
+				return 0;
 			}
-		}
-		
-		// clean up the top side rows by applying zero padding
-		for(int i = 0; i < padsize; i++)
-		{
-			for(int j = 0; j < Tsr_In->col; j++)
+			
+			// Reflection is periodic with period 2*(len - 1)
+			int period = 2*(len - 1);
+			
+			idx %= period;
+			
+			if (idx < 0)
 			{
-				Tsr_In->vals[k][i][j] = 0.0f;
+				idx += period;
 			}
+			
+			return (idx < len) ? idx : period - idx;
 		}
 		
-		// clean up the left side columns by applying zero padding
-		for(int i = 0; i < Tsr_In->row; i++)
-		{
-			for(int j = 0; j < padsize; j++)
-			{
-				Tsr_In->vals[k][i][j] = 0.0f;
-			}
-		}
-
+		case BORDER_REPLICATE:
+			return (idx < 0) ? 0 : len - 1;
+		
+		case BORDER_WRAP:
+			idx %= len;
+			return (idx < 0) ? idx + len : idx;
+		
+		default:
+			return -1;
 	}
 }
@@ -51,11 +51,25 @@
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
+#include <string.h>
 
 #include "vector.h"
 #include "matrix.h"
 #include "tensor.h"
 
+/**
+ * @brief	Border modes for spatial operations
+ * 
+ * Define how elements outside of the input are resolved, e.g. for input abcd:
+ */
+typedef enum Border_Mode
+{
+	BORDER_CONSTANT = 0,	/**< constant value, e.g. zero padding:	000|abcd|000 */
+	BORDER_REFLECT,			/**< mirror without repeating the edge:	dcb|abcd|cba */
+	BORDER_REPLICATE,		/**< repeat the edge element:			aaa|abcd|ddd */
+	BORDER_WRAP				/**< periodic repetition:				bcd|abcd|abc */
+} Border_Mode;
+
 /**
  * @brief	Asymmetric padding on vector
  * @param 	Vec_In
@@ -102,7 +116,8 @@ Tensor padding_2d_asymmetric_Tsr_wCPU(Tensor *Tsr_In, int row_padsize, int col_p
  * @note	Use this function when integrating padding with another function
  * 
  * This function pads the input vector after its last element and 
- * return a new vector
+ * replace it with the padded vector.
+ * A view input is padded into a new object, the storage of its parent is left as is.
  */
 void vpadding_asymmetric_Vec_wCPU(Vector *Vec_In, int padsize);
 
@@ -115,7 +130,8 @@ void vpadding_asymmetric_Vec_wCPU(Vector *Vec_In, int padsize);
  * @note	Use this function when integrating padding with another function
  * 
  * This function pads the input matrix at the last element of each row, 
- * adds extra zero-padding rows at the bottom and return a new matrix
+ * adds extra zero-padding rows at the bottom and replace it with the padded matrix.
+ * A view input is padded into a new object, the storage of its parent is left as is.
  */
 void vpadding_2d_asymmetric_Mat_wCPU(Matrix *Mat_In, int row_padsize, int col_padsize);
 
@@ -128,7 +144,8 @@ void vpadding_2d_asymmetric_Mat_wCPU(Matrix *Mat_In, int row_padsize, int col_pa
  * @note	Use this function when integrating padding with another function
  * 
  * This function performs 2D zero-padding at each matrix layer of the input tensor except
- * the depth layer and return a new tensor.\n
+ * the depth layer and replace it with the padded tensor.
+ * A view input is padded into a new object, the storage of its parent is left as is.
  */
 void vpadding_2d_asymmetric_Tsr_wCPU(Tensor *Tsr_In, int row_padsize, int col_padsize);
 
@@ -167,6 +184,34 @@ Matrix padding_2d_Mat_wCPU(Matrix *Mat_In, int padsize);
  */
 Tensor padding_2d_Tsr_wCPU(Tensor *Tsr_In, int padsize);
 
+/**
+ * @brief	Symmetric padding on matrix into a preallocated matrix
+ * @param 	Mat_In
+ * @param 	padsize
+ * @param 	Mat_Out
+ * @return 	None
+ * @note	Use this function to reuse a workspace across calls without allocating
+ * 
+ * This function writes the input matrix zero-padded at all of its sides into Mat_Out,
+ * which must be (row + 2*padsize) x (col + 2*padsize) and must not alias Mat_In.
+ * Every element of Mat_Out is overwritten, so the workspace need not be cleared.
+ */
+void padding_2d_into_Mat_wCPU(Matrix *Mat_In, int padsize, Matrix *Mat_Out);
+
+/**
+ * @brief	Symmetric padding on tensor into a preallocated tensor
+ * @param 	Tsr_In
+ * @param 	padsize
+ * @param 	Tsr_Out
+ * @return 	None
+ * @note	Use this function to reuse a workspace across calls without allocating
+ * 
+ * This function writes the input tensor zero-padded at all of its sides except its depth
+ * into Tsr_Out, which must have the padded dimension and must not alias Tsr_In.
+ * Layers are padded in parallel.
+ */
+void padding_2d_into_Tsr_wCPU(Tensor *Tsr_In, int padsize, Tensor *Tsr_Out);
+
 /**
  * @brief	Symmetric padding on matrix
  * @param 	Mat_In
@@ -174,7 +219,8 @@ Tensor padding_2d_Tsr_wCPU(Tensor *Tsr_In, int padsize);
  * @return 	None
  * @note	Use this function when integrating padding with another function
  * 
- * This function pads the input matrix at all of its sides and return a new matrix
+ * This function pads the input matrix at all of its sides and replace it with the padded matrix.
+ * A view input is padded into a new object, the storage of its parent is left as is.
  */
 void vpadding_2d_Mat_wCPU(Matrix *Mat_In, int padsize);
 
@@ -186,8 +232,23 @@ void vpadding_2d_Mat_wCPU(Matrix *Mat_In, int padsize);
  * @note	Use this function when integrating padding with another function
  * 
  * This function pads the input tensor at all of its sides except its depth
- * and return a new tensor
+ * and replace it with the padded tensor.
+ * A view input is padded into a new object, the storage of its parent is left as is.
  */
 void vpadding_2d_Tsr_wCPU(Tensor *Tsr_In, int padsize);
 
+/**
+ * @brief	Resolve an index outside of the input
+ * @param 	idx
+ * @param 	len
+ * @param 	mode
+ * @return 	int
+ * 
+ * This function maps index idx of a line with len elements into [0, len) according to
+ * the border mode, or return -1 if the element is the constant value (BORDER_CONSTANT).
+ * Indices inside the line are returned as is. Used by operations that resolve 
+ * borders on the fly instead of copying the input into a padded buffer.
+ */
+int border_index(int idx, int len, Border_Mode mode);
+
 #endif /* PADDING_H */
@@ -25,8 +25,8 @@
  * @brief Source file on detailed implementation for pooling functions
  *
  * Pooling is a method of downsampling the layer in a non-linear fashion.\n
- * Only max-pooling is supported in this implementation as it is the most 
- * common one found in deep learning networks.
+ * Max-pooling, average-pooling and their global variants (one value per layer)
+ * are supported in this implementation.
  * 
  * @author Andriyanto Halim
  * @date 16 May 2018
@@ -42,115 +42,766 @@
  
 #include "pooling.h"
 
-Matrix maxpooling_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride)
+// Number of windows of maxpooling_Mat/Tsr_wCPU() along one dimension: the last window may be
+// cut at the border, but every window starts inside the input
+static int maxpooling_ceil_size(int len, int filter, int stride)
 {
-    assert(filter_height == filter_width);
-    assert(filter_height == stride || filter_width == stride);
-   
-    // Calculate the needed padding_2d
-    int temprowpad = stride - (Mat_In->row%stride);
-    int tempcolpad = stride - (Mat_In->col%stride);
-
-	// Perform padding_2d on Input Matrix
-    vpadding_2d_asymmetric_Mat_wCPU(Mat_In, temprowpad, tempcolpad);
-    
-    // Calculate MaxPooling Output Matrix dimension based on the padded Input Matrix
-	int temprow = Mat_In->row/filter_height;
-    int tempcol = Mat_In->col/filter_width;
-            
-    Matrix tempMat = create_matrix(temprow, tempcol);    
-    
-    // p and q are the row- and col- indices of the maxpooling output matrix
-    int p = 0;
-    
-    // i and j are the row- and col- indices of the input matrix
-    for (int i = 0; i < Mat_In->row; i+= stride)
-    {        
-        int q = 0;
-        
-        for (int j = 0; j < Mat_In->col; j+= stride)
-        {
-            // Initialize a temp variable to store max value at the beginning of maxpool stride
-            float tempmax = 0.0f;
-    
-            // m and n are the row- and col- indices of inner loop within each maxpool stride to find the max value
-            for(int m = 0; m < filter_height; m++)
-            {
-                for(int n = 0; n < filter_width; n++)
-                {
-                    if(Mat_In->vals[m+i][n+j] > tempmax)
-                    {
-                        tempmax = Mat_In->vals[m+i][n+j];
-                    }                        
-                }
-            }
-            
-            // Assign tempmax value once stride is finished.
-            tempMat.vals[p][q] = tempmax;    
-            
-            q++;
-        }
-        
-        p++;
-    }
-    
-    return tempMat;
+	int tempsize = (len > filter ? len - filter + stride - 1 : 0)/stride + 1;
+	int maxsize = (len - 1)/stride + 1;
+	
+	return (tempsize < maxsize) ? tempsize : maxsize;
 }
 
-Tensor maxpooling_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride)
+// Maxpooling of one layer, windows start at p*stride - padsize and are cut at the border.
+// The innermost loop runs along the output row over the columns whose window tap is
+// inside the input, so it has no branch and can be vectorized.
+static void maxpooling_2d_layer(float **invals, int inrow, int incol, float **outvals, int temprow, int tempcol,
+								int filter_height, int filter_width, int stride, int padsize)
 {
-	assert(filter_height == filter_width);
-    assert(filter_height == stride || filter_width == stride);
-   
-    // Calculate the needed padding_2d
-    int temprowpad = stride - (Tsr_In->row%stride);
-    int tempcolpad = stride - (Tsr_In->col%stride);
-
-	// Perform padding_2d on each input matrix layer
-    vpadding_2d_asymmetric_Tsr_wCPU(Tsr_In, temprowpad, tempcolpad);
-    
-    // Calculate MaxPooling Output Matrix dimension based on the padded Input Matrix
-	int temprow = Tsr_In->row/filter_height;
-    int tempcol = Tsr_In->col/filter_width;
-            
-    Tensor tempTsr = create_tensor(temprow, tempcol, Tsr_In->depth);    
-    
-    for(int k = 0; k < Tsr_In->depth; k++)
-    {
-		// p and q are the row- and col- indices of the maxpooling output matrix
-		int p = 0;
-		
-		// i and j are the row- and col- indices of the input matrix
-		for (int i = 0; i < Tsr_In->row; i+= stride)
-		{        
-			int q = 0;
-			
-			for (int j = 0; j < Tsr_In->col; j+= stride)
-			{
-				// Initialize a temp variable to store max value at the beginning of maxpool stride
-				float tempmax = 0.0f;
-		
-				// m and n are the row- and col- indices of inner loop within each maxpool stride to find the max value
-				for(int m = 0; m < filter_height; m++)
+	for (int p = 0; p < temprow; p++)
+	{
+		float *outrow = outvals[p];
+		
+		for (int q = 0; q < tempcol; q++)
+		{
+			outrow[q] = -INFINITY;
+		}
+		
+		int rowstart = p*stride - padsize;
+		int rowend = rowstart + filter_height;
+		
+		for (int i = (rowstart > 0 ? rowstart : 0); i < rowend && i < inrow; i++)
+		{
+			float *src = invals[i];
+			
+			for (int n = 0; n < filter_width; n++)
+			{
+				// Output columns q whose input column q*stride - padsize + n is inside
+				int offset = n - padsize;
+				int qstart = (offset < 0) ? (-offset + stride - 1)/stride : 0;
+				int qend = (incol - 1 - offset >= 0) ? (incol - 1 - offset)/stride + 1 : 0;
+				
+				if (qend > tempcol)
+				{
+					qend = tempcol;
+				}
+				
+				for (int q = qstart; q < qend; q++)
+				{
+					float val = src[q*stride + offset];
+					outrow[q] = (val > outrow[q]) ? val : outrow[q];
+				}
+			}
+		}
+	}
+}
+
+// Scratch of maxpooling_2d_layer_vhgw(): the row-pass result with its column-wise prefix 
+// and suffix max, followed by the line buffers of a serial row pass
+static float *maxpooling_vhgw_work(int temprow, int tempcol, int filter_height, int filter_width, int stride)
+{
+	int linecol = (tempcol - 1)*stride + filter_width;
+	int linerow = (temprow - 1)*stride + filter_height;
+	
+	float *work = malloc((3*(size_t)linerow*tempcol + 3*(size_t)linecol) * sizeof(float));
+	assert(work != NULL);
+	
+	return work;
+}
+
+// Max filter of one layer with the van Herk/Gil-Werman algorithm, same window placement
+// as maxpooling_2d_layer(). Each line is split into blocks of the window size; the max of 
+// a window is the max of the suffix max of the block it starts in and the prefix max of 
+// the block it ends in, i.e. about 3 comparisons per element regardless of window size.
+// The row pass runs along each input row, the column pass runs on whole rows at once.
+// Elements outside the input (padding, windows cut at the border) count as -INFINITY.
+// work comes from maxpooling_vhgw_work(). With parallel set the rows of the layer are 
+// split over threads, otherwise the caller is expected to parallelize over layers.
+static void maxpooling_2d_layer_vhgw(float **invals, int inrow, int incol, float **outvals, int temprow, int tempcol,
+									 int filter_height, int filter_width, int stride, int padsize, float *work, int parallel)
+{
+	// Length of the padded lines covering all windows
+	int linecol = (tempcol - 1)*stride + filter_width;
+	int linerow = (temprow - 1)*stride + filter_height;
+	
+	// Row pass result and its prefix and suffix max, one row per padded input row
+	float *rowmax = work;
+	float *colprefix = rowmax + (size_t)linerow*tempcol;
+	float *colsuffix = colprefix + (size_t)linerow*tempcol;
+	
+	#pragma omp parallel if (parallel)
+	{
+		float *line = parallel ? malloc(3*linecol * sizeof(float)) : colsuffix + (size_t)linerow*tempcol;
+		assert(line != NULL);
+		
+		float *prefix = line + linecol;
+		float *suffix = prefix + linecol;
+		
+		#pragma omp for
+		for (int r = 0; r < linerow; r++)
+		{
+			int i = r - padsize;
+			float *dst = rowmax + (size_t)r*tempcol;
+			
+			if (i < 0 || i >= inrow)
+			{
+				for (int q = 0; q < tempcol; q++)
+				{
+					dst[q] = -INFINITY;
+				}
+				
+				continue;
+			}
+			
+			for (int x = 0; x < linecol; x++)
+			{
+				int j = x - padsize;
+				line[x] = (j >= 0 && j < incol) ? invals[i][j] : -INFINITY;
+			}
+			
+			for (int x = 0; x < linecol; x++)
+			{
+				prefix[x] = (x % filter_width == 0 || line[x] > prefix[x - 1]) ? line[x] : prefix[x - 1];
+			}
+			
+			for (int x = linecol - 1; x >= 0; x--)
+			{
+				suffix[x] = (x == linecol - 1 || x % filter_width == filter_width - 1 || line[x] > suffix[x + 1]) ? line[x] : suffix[x + 1];
+			}
+			
+			for (int q = 0; q < tempcol; q++)
+			{
+				float left = suffix[q*stride];
+				float right = prefix[q*stride + filter_width - 1];
+				
+				dst[q] = (left > right) ? left : right;
+			}
+		}
+		
+		if (parallel)
+		{
+			free(line);
+		}
+		
+		// Column pass, prefix and suffix max of whole rows within each block of filter_height rows
+		#pragma omp for
+		for (int block = 0; block < linerow; block += filter_height)
+		{
+			int blockend = (block + filter_height < linerow) ? block + filter_height : linerow;
+			
+			memcpy(colprefix + (size_t)block*tempcol, rowmax + (size_t)block*tempcol, tempcol * sizeof(float));
+			memcpy(colsuffix + (size_t)(blockend - 1)*tempcol, rowmax + (size_t)(blockend - 1)*tempcol, tempcol * sizeof(float));
+			
+			for (int r = block + 1; r < blockend; r++)
+			{
+				float *prev = colprefix + (size_t)(r - 1)*tempcol;
+				float *src = rowmax + (size_t)r*tempcol;
+				float *dst = colprefix + (size_t)r*tempcol;
+				
+				for (int q = 0; q < tempcol; q++)
+				{
+					dst[q] = (src[q] > prev[q]) ? src[q] : prev[q];
+				}
+			}
+			
+			for (int r = blockend - 2; r >= block; r--)
+			{
+				float *next = colsuffix + (size_t)(r + 1)*tempcol;
+				float *src = rowmax + (size_t)r*tempcol;
+				float *dst = colsuffix + (size_t)r*tempcol;
+				
+				for (int q = 0; q < tempcol; q++)
 				{
-					for(int n = 0; n < filter_width; n++)
+					dst[q] = (src[q] > next[q]) ? src[q] : next[q];
+				}
+			}
+		}
+		
+		#pragma omp for
+		for (int p = 0; p < temprow; p++)
+		{
+			float *top = colsuffix + (size_t)p*stride*tempcol;
+			float *bottom = colprefix + (size_t)(p*stride + filter_height - 1)*tempcol;
+			float *outrow = outvals[p];
+			
+			for (int q = 0; q < tempcol; q++)
+			{
+				outrow[q] = (top[q] > bottom[q]) ? top[q] : bottom[q];
+			}
+		}
+	}
+}
+
+// Pick the direct or the van Herk/Gil-Werman max pooling. The direct one costs
+// filter_height*filter_width per output element, the other one about 3*(stride*stride + stride)
+static int maxpooling_use_vhgw(int filter_height, int filter_width, int stride)
+{
+	return filter_height * filter_width > 6*(stride*stride + stride);
+}
+
+// Max pooling of one layer with van Herk/Gil-Werman when work is given, direct otherwise
+static void maxpooling_2d_layer_auto(float **invals, int inrow, int incol, float **outvals, int temprow, int tempcol,
+									 int filter_height, int filter_width, int stride, int padsize, float *work, int parallel)
+{
+	if (work != NULL)
+	{
+		maxpooling_2d_layer_vhgw(invals, inrow, incol, outvals, temprow, tempcol, filter_height, filter_width, stride, padsize, work, parallel);
+	}
+	else
+	{
+		maxpooling_2d_layer(invals, inrow, incol, outvals, temprow, tempcol, filter_height, filter_width, stride, padsize);
+	}
+}
+
+// Average pooling of one layer, same window placement as maxpooling_2d_layer()
+static void avgpooling_2d_layer(float **invals, int inrow, int incol, float **outvals, int temprow, int tempcol,
+								int filter_height, int filter_width, int stride, int padsize, int count_include_pad)
+{
+	for (int p = 0; p < temprow; p++)
+	{
+		float *outrow = outvals[p];
+		
+		for (int q = 0; q < tempcol; q++)
+		{
+			outrow[q] = 0.0f;
+		}
+		
+		int rowstart = p*stride - padsize;
+		int rowend = rowstart + filter_height;
+		int rowfirst = (rowstart > 0) ? rowstart : 0;
+		int rowlast = (rowend < inrow) ? rowend : inrow;
+		
+		for (int i = rowfirst; i < rowlast; i++)
+		{
+			float *src = invals[i];
+			
+			for (int n = 0; n < filter_width; n++)
+			{
+				// Output columns q whose input column q*stride - padsize + n is inside
+				int offset = n - padsize;
+				int qstart = (offset < 0) ? (-offset + stride - 1)/stride : 0;
+				int qend = (incol - 1 - offset >= 0) ? (incol - 1 - offset)/stride + 1 : 0;
+				
+				if (qend > tempcol)
+				{
+					qend = tempcol;
+				}
+				
+				for (int q = qstart; q < qend; q++)
+				{
+					outrow[q] += src[q*stride + offset];
+				}
+			}
+		}
+		
+		if (count_include_pad)
+		{
+			float scale = 1.0f/(filter_height * filter_width);
+			
+			for (int q = 0; q < tempcol; q++)
+			{
+				outrow[q] *= scale;
+			}
+		}
+		else
+		{
+			int rowcount = rowlast - rowfirst;
+			
+			for (int q = 0; q < tempcol; q++)
+			{
+				int colstart = q*stride - padsize;
+				int colend = colstart + filter_width;
+				int colcount = ((colend < incol) ? colend : incol) - ((colstart > 0) ? colstart : 0);
+				
+				outrow[q] /= (float)(rowcount * colcount);
+			}
+		}
+	}
+}
+
+// Max or average pooling of one layer with borders resolved on the fly by the border mode.
+// Window taps inside the input take the contiguous path, the others go through the column map.
+// Average pooling without count_include_pad skips the border taps altogether.
+static void pooling_2d_border_layer(float **invals, int inrow, int incol, float **outvals, int temprow, int tempcol,
+									int filter_height, int filter_width, int stride, int padsize, 
+									Border_Mode mode, float value, int is_max, int count_include_pad)
+{
+	int linecol = (tempcol - 1)*stride + filter_width;
+	int *colmap = malloc(linecol * sizeof(int));
+	int skip_border = !is_max && !count_include_pad;
+	
+	for (int x = 0; x < linecol; x++)
+	{
+		colmap[x] = border_index(x - padsize, incol, mode);
+	}
+	
+	for (int p = 0; p < temprow; p++)
+	{
+		float *outrow = outvals[p];
+		
+		for (int q = 0; q < tempcol; q++)
+		{
+			outrow[q] = is_max ? -INFINITY : 0.0f;
+		}
+		
+		for (int m = 0; m < filter_height; m++)
+		{
+			int r = p*stride + m - padsize;
+			
+			if (skip_border && (r < 0 || r >= inrow))
+			{
+				continue;
+			}
+			
+			int i = border_index(r, inrow, mode);
+			
+			for (int n = 0; n < filter_width; n++)
+			{
+				// Output columns q whose input column q*stride - padsize + n is inside
+				int offset = n - padsize;
+				int qstart = (offset < 0) ? (-offset + stride - 1)/stride : 0;
+				int qend = (incol - 1 - offset >= 0) ? (incol - 1 - offset)/stride + 1 : 0;
+				
+				qend = (qend < tempcol) ? qend : tempcol;
+				qstart = (qstart < qend) ? qstart : qend;
+				
+				// Whole window row is the constant value
+				if (i < 0)
+				{
+					for (int q = 0; q < tempcol; q++)
 					{
-						if(Tsr_In->vals[k][m+i][n+j] > tempmax)
-						{
-							tempmax = Tsr_In->vals[k][m+i][n+j];
-						}                        
+						outrow[q] = is_max ? ((value > outrow[q]) ? value : outrow[q]) : outrow[q] + value;
 					}
+					
+					continue;
 				}
 				
-				// Assign tempmax value once stride is finished.
-				tempTsr.vals[k][p][q] = tempmax;    
+				// Left and right border columns go through the column map
+				for (int q = 0; q < qstart && !skip_border; q++)
+				{
+					int j = colmap[q*stride + n];
+					float val = (j >= 0) ? invals[i][j] : value;
+					
+					outrow[q] = is_max ? ((val > outrow[q]) ? val : outrow[q]) : outrow[q] + val;
+				}
 				
-				q++;
+				for (int q = qend; q < tempcol && !skip_border; q++)
+				{
+					int j = colmap[q*stride + n];
+					float val = (j >= 0) ? invals[i][j] : value;
+					
+					outrow[q] = is_max ? ((val > outrow[q]) ? val : outrow[q]) : outrow[q] + val;
+				}
+				
+				float *src = invals[i];
+				
+				if (is_max)
+				{
+					for (int q = qstart; q < qend; q++)
+					{
+						float val = src[q*stride + offset];
+						outrow[q] = (val > outrow[q]) ? val : outrow[q];
+					}
+				}
+				else
+				{
+					for (int q = qstart; q < qend; q++)
+					{
+						outrow[q] += src[q*stride + offset];
+					}
+				}
+			}
+		}
+		
+		if (!is_max && count_include_pad)
+		{
+			float scale = 1.0f/(filter_height * filter_width);
+			
+			for (int q = 0; q < tempcol; q++)
+			{
+				outrow[q] *= scale;
+			}
+		}
+		else if (!is_max)
+		{
+			// Only the window taps inside the input are counted
+			int rowstart = p*stride - padsize;
+			int rowend = rowstart + filter_height;
+			int rowcount = ((rowend < inrow) ? rowend : inrow) - ((rowstart > 0) ? rowstart : 0);
+			
+			for (int q = 0; q < tempcol; q++)
+			{
+				int colstart = q*stride - padsize;
+				int colend = colstart + filter_width;
+				int colcount = ((colend < incol) ? colend : incol) - ((colstart > 0) ? colstart : 0);
+				
+				outrow[q] /= (float)(rowcount * colcount);
+			}
+		}
+	}
+	
+	free(colmap);
+}
+
+Matrix maxpooling_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride)
+{
+	assert(stride > 0);
+	assert(filter_height > 0 && filter_width > 0);
+	
+	// Calculate output matrix size, the last window may be cut at the border
+	int temprow = maxpooling_ceil_size(Mat_In->row, filter_height, stride);
+	int tempcol = maxpooling_ceil_size(Mat_In->col, filter_width, stride);
+	
+	Matrix tempMat = create_matrix(temprow, tempcol);
+	
+	// Rows of the single layer are split over threads
+	float *work = maxpooling_use_vhgw(filter_height, filter_width, stride) ? 
+				  maxpooling_vhgw_work(temprow, tempcol, filter_height, filter_width, stride) : NULL;
+	
+	maxpooling_2d_layer_auto(Mat_In->vals, Mat_In->row, Mat_In->col, tempMat.vals, temprow, tempcol,
+						filter_height, filter_width, stride, 0, work, 1);
+	
+	free(work);
+	
+	return tempMat;
+}
+
+Tensor maxpooling_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride)
+{
+	assert(stride > 0);
+	assert(filter_height > 0 && filter_width > 0);
+	
+	// Calculate output tensor size, the last window may be cut at the border
+	int temprow = maxpooling_ceil_size(Tsr_In->row, filter_height, stride);
+	int tempcol = maxpooling_ceil_size(Tsr_In->col, filter_width, stride);
+	
+	Tensor tempTsr = create_tensor(temprow, tempcol, Tsr_In->depth);
+	
+	int usevhgw = maxpooling_use_vhgw(filter_height, filter_width, stride);
+	
+	// Layers are split over threads, each thread keeps one scratch for all its layers
+	#pragma omp parallel
+	{
+		float *work = usevhgw ? maxpooling_vhgw_work(temprow, tempcol, filter_height, filter_width, stride) : NULL;
+		
+		#pragma omp for
+		for (int k = 0; k < Tsr_In->depth; k++)
+		{
+			maxpooling_2d_layer_auto(Tsr_In->vals[k], Tsr_In->row, Tsr_In->col, tempTsr.vals[k], temprow, tempcol,
+								filter_height, filter_width, stride, 0, work, 0);
+		}
+		
+		free(work);
+	}
+	
+	return tempTsr;
+}
+
+Matrix maxpooling_2d_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride, int padsize)
+{
+	assert(stride > 0);
+	assert(padsize >= 0 && padsize < filter_height && padsize < filter_width);
+	assert(Mat_In->row + 2*padsize >= filter_height && Mat_In->col + 2*padsize >= filter_width);
+	
+	// Calculate output matrix size
+	int temprow = (Mat_In->row + 2*padsize - filter_height)/stride + 1;
+	int tempcol = (Mat_In->col + 2*padsize - filter_width)/stride + 1;
+	
+	Matrix tempMat = create_matrix(temprow, tempcol);
+	
+	// Rows of the single layer are split over threads
+	float *work = maxpooling_use_vhgw(filter_height, filter_width, stride) ? 
+				  maxpooling_vhgw_work(temprow, tempcol, filter_height, filter_width, stride) : NULL;
+	
+	maxpooling_2d_layer_auto(Mat_In->vals, Mat_In->row, Mat_In->col, tempMat.vals, temprow, tempcol,
+						filter_height, filter_width, stride, padsize, work, 1);
+	
+	free(work);
+	
+	return tempMat;
+}
+
+Tensor maxpooling_2d_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride, int padsize)
+{
+	assert(stride > 0);
+	assert(padsize >= 0 && padsize < filter_height && padsize < filter_width);
+	assert(Tsr_In->row + 2*padsize >= filter_height && Tsr_In->col + 2*padsize >= filter_width);
+	
+	// Calculate output tensor size
+	int temprow = (Tsr_In->row + 2*padsize - filter_height)/stride + 1;
+	int tempcol = (Tsr_In->col + 2*padsize - filter_width)/stride + 1;
+	
+	Tensor tempTsr = create_tensor(temprow, tempcol, Tsr_In->depth);
+	
+	int usevhgw = maxpooling_use_vhgw(filter_height, filter_width, stride);
+	
+	// Layers are split over threads, each thread keeps one scratch for all its layers
+	#pragma omp parallel
+	{
+		float *work = usevhgw ? maxpooling_vhgw_work(temprow, tempcol, filter_height, filter_width, stride) : NULL;
+		
+		#pragma omp for
+		for (int k = 0; k < Tsr_In->depth; k++)
+		{
+			maxpooling_2d_layer_auto(Tsr_In->vals[k], Tsr_In->row, Tsr_In->col, tempTsr.vals[k], temprow, tempcol,
+								filter_height, filter_width, stride, padsize, work, 0);
+		}
+		
+		free(work);
+	}
+	
+	return tempTsr;
+}
+
+Matrix avgpooling_2d_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride, int padsize, int count_include_pad)
+{
+	assert(stride > 0);
+	assert(padsize >= 0 && padsize < filter_height && padsize < filter_width);
+	assert(Mat_In->row + 2*padsize >= filter_height && Mat_In->col + 2*padsize >= filter_width);
+	
+	// Calculate output matrix size
+	int temprow = (Mat_In->row + 2*padsize - filter_height)/stride + 1;
+	int tempcol = (Mat_In->col + 2*padsize - filter_width)/stride + 1;
+	
+	Matrix tempMat = create_matrix(temprow, tempcol);
+	
+	avgpooling_2d_layer(Mat_In->vals, Mat_In->row, Mat_In->col, tempMat.vals, temprow, tempcol,
+						filter_height, filter_width, stride, padsize, count_include_pad);
+	
+	return tempMat;
+}
+
+Tensor avgpooling_2d_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride, int padsize, int count_include_pad)
+{
+	assert(stride > 0);
+	assert(padsize >= 0 && padsize < filter_height && padsize < filter_width);
+	assert(Tsr_In->row + 2*padsize >= filter_height && Tsr_In->col + 2*padsize >= filter_width);
+	
+	// Calculate output tensor size
+	int temprow = (Tsr_In->row + 2*padsize - filter_height)/stride + 1;
+	int tempcol = (Tsr_In->col + 2*padsize - filter_width)/stride + 1;
+	
+	Tensor tempTsr = create_tensor(temprow, tempcol, Tsr_In->depth);
+	
+	#pragma omp parallel for
+	for (int k = 0; k < Tsr_In->depth; k++)
+	{
+		avgpooling_2d_layer(Tsr_In->vals[k], Tsr_In->row, Tsr_In->col, tempTsr.vals[k], temprow, tempcol,
+							filter_height, filter_width, stride, padsize, count_include_pad);
+	}
+	
+	return tempTsr;
+}
+
+Vector global_avgpooling_Tsr_wCPU(Tensor *Tsr_In)
+{
+	Vector tempVec = create_vector(Tsr_In->depth);
+	
+	#pragma omp parallel for
+	for (int k = 0; k < Tsr_In->depth; k++)
+	{
+		// Independent partial sums let the compiler vectorize the reduction
+		float lanes[8] = {0.0f};
+		float tempsum = 0.0f;
+		
+		for (int i = 0; i < Tsr_In->row; i++)
+		{
+			float *src = Tsr_In->vals[k][i];
+			int j = 0;
+			
+			for (; j + 8 <= Tsr_In->col; j += 8)
+			{
+				for (int l = 0; l < 8; l++)
+				{
+					lanes[l] += src[j + l];
+				}
 			}
 			
-			p++;
+			for (; j < Tsr_In->col; j++)
+			{
+				tempsum += src[j];
+			}
+		}
+		
+		for (int l = 0; l < 8; l++)
+		{
+			tempsum += lanes[l];
 		}
+		
+		tempVec.vals[k] = tempsum/(Tsr_In->row * Tsr_In->col);
+	}
+	
+	return tempVec;
+}
+
+Vector global_maxpooling_Tsr_wCPU(Tensor *Tsr_In)
+{
+	Vector tempVec = create_vector(Tsr_In->depth);
+	
+	#pragma omp parallel for
+	for (int k = 0; k < Tsr_In->depth; k++)
+	{
+		// Independent partial maxima let the compiler vectorize the reduction
+		float lanes[8] = {-INFINITY, -INFINITY, -INFINITY, -INFINITY, -INFINITY, -INFINITY, -INFINITY, -INFINITY};
+		float tempmax = -INFINITY;
+		
+		for (int i = 0; i < Tsr_In->row; i++)
+		{
+			float *src = Tsr_In->vals[k][i];
+			int j = 0;
+			
+			for (; j + 8 <= Tsr_In->col; j += 8)
+			{
+				for (int l = 0; l < 8; l++)
+				{
+					lanes[l] = (src[j + l] > lanes[l]) ? src[j + l] : lanes[l];
+				}
+			}
+			
+			for (; j < Tsr_In->col; j++)
+			{
+				tempmax = (src[j] > tempmax) ? src[j] : tempmax;
+			}
+		}
+		
+		for (int l = 0; l < 8; l++)
+		{
+			tempmax = (lanes[l] > tempmax) ? lanes[l] : tempmax;
+		}
+		
+		tempVec.vals[k] = tempmax;
+	}
+	
+	return tempVec;
+}
+
+Matrix max_filter_2d_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width)
+{
+	assert(filter_height > 0 && filter_width > 0);
+	assert(Mat_In->row >= filter_height && Mat_In->col >= filter_width);
+	
+	// Calculate output matrix size
+	int temprow = Mat_In->row - filter_height + 1;
+	int tempcol = Mat_In->col - filter_width + 1;
+	
+	Matrix tempMat = create_matrix(temprow, tempcol);
+	
+	// Rows of the single layer are split over threads
+	float *work = maxpooling_vhgw_work(temprow, tempcol, filter_height, filter_width, 1);
+	
+	maxpooling_2d_layer_vhgw(Mat_In->vals, Mat_In->row, Mat_In->col, tempMat.vals, temprow, tempcol,
+							 filter_height, filter_width, 1, 0, work, 1);
+	
+	free(work);
+	
+	return tempMat;
+}
+
+Tensor max_filter_2d_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width)
+{
+	assert(filter_height > 0 && filter_width > 0);
+	assert(Tsr_In->row >= filter_height && Tsr_In->col >= filter_width);
+	
+	// Calculate output tensor size
+	int temprow = Tsr_In->row - filter_height + 1;
+	int tempcol = Tsr_In->col - filter_width + 1;
+	
+	Tensor tempTsr = create_tensor(temprow, tempcol, Tsr_In->depth);
+	
+	// Layers are split over threads, each thread keeps one scratch for all its layers
+	#pragma omp parallel
+	{
+		float *work = maxpooling_vhgw_work(temprow, tempcol, filter_height, filter_width, 1);
+		
+		#pragma omp for
+		for (int k = 0; k < Tsr_In->depth; k++)
+		{
+			maxpooling_2d_layer_vhgw(Tsr_In->vals[k], Tsr_In->row, Tsr_In->col, tempTsr.vals[k], temprow, tempcol,
+									 filter_height, filter_width, 1, 0, work, 0);
+		}
+		
+		free(work);
+	}
+	
+	return tempTsr;
+}
+
+Matrix maxpooling_2d_with_border_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride, int padsize, Border_Mode mode, float value)
+{
+	assert(stride > 0);
+	assert(padsize >= 0 && padsize < filter_height && padsize < filter_width);
+	assert(Mat_In->row + 2*padsize >= filter_height && Mat_In->col + 2*padsize >= filter_width);
+	
+	// Calculate output matrix size
+	int temprow = (Mat_In->row + 2*padsize - filter_height)/stride + 1;
+	int tempcol = (Mat_In->col + 2*padsize - filter_width)/stride + 1;
+	
+	Matrix tempMat = create_matrix(temprow, tempcol);
+	
+	pooling_2d_border_layer(Mat_In->vals, Mat_In->row, Mat_In->col, tempMat.vals, temprow, tempcol,
+							filter_height, filter_width, stride, padsize, mode, value, 1, 0);
+	
+	return tempMat;
+}
+
+Tensor maxpooling_2d_with_border_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride, int padsize, Border_Mode mode, float value)
+{
+	assert(stride > 0);
+	assert(padsize >= 0 && padsize < filter_height && padsize < filter_width);
+	assert(Tsr_In->row + 2*padsize >= filter_height && Tsr_In->col + 2*padsize >= filter_width);
+	
+	// Calculate output tensor size
+	int temprow = (Tsr_In->row + 2*padsize - filter_height)/stride + 1;
+	int tempcol = (Tsr_In->col + 2*padsize - filter_width)/stride + 1;
+	
+	Tensor tempTsr = create_tensor(temprow, tempcol, Tsr_In->depth);
+	
+	#pragma omp parallel for
+	for (int k = 0; k < Tsr_In->depth; k++)
+	{
+		pooling_2d_border_layer(Tsr_In->vals[k], Tsr_In->row, Tsr_In->col, tempTsr.vals[k], temprow, tempcol,
+								filter_height, filter_width, stride, padsize, mode, value, 1, 0);
+	}
+	
+	return tempTsr;
+}
+
+Matrix avgpooling_2d_with_border_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride, int padsize, Border_Mode mode, float value, int count_include_pad)
+{
+	assert(stride > 0);
+	assert(padsize >= 0 && padsize < filter_height && padsize < filter_width);
+	assert(Mat_In->row + 2*padsize >= filter_height && Mat_In->col + 2*padsize >= filter_width);
+	
+	// Calculate output matrix size
+	int temprow = (Mat_In->row + 2*padsize - filter_height)/stride + 1;
+	int tempcol = (Mat_In->col + 2*padsize - filter_width)/stride + 1;
+	
+	Matrix tempMat = create_matrix(temprow, tempcol);
+	
+	pooling_2d_border_layer(Mat_In->vals, Mat_In->row, Mat_In->col, tempMat.vals, temprow, tempcol,
+							filter_height, filter_width, stride, padsize, mode, value, 0, count_include_pad);
+	
+	return tempMat;
+}
+
+Tensor avgpooling_2d_with_border_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride, int padsize, Border_Mode mode, float value, int count_include_pad)
+{
+	assert(stride > 0);
+	assert(padsize >= 0 && padsize < filter_height && padsize < filter_width);
+	assert(Tsr_In->row + 2*padsize >= filter_height && Tsr_In->col + 2*padsize >= filter_width);
+	
+	// Calculate output tensor size
+	int temprow = (Tsr_In->row + 2*padsize - filter_height)/stride + 1;
+	int tempcol = (Tsr_In->col + 2*padsize - filter_width)/stride + 1;
+	
+	Tensor tempTsr = create_tensor(temprow, tempcol, Tsr_In->depth);
+	
+	#pragma omp parallel for
+	for (int k = 0; k < Tsr_In->depth; k++)
+	{
+		pooling_2d_border_layer(Tsr_In->vals[k], Tsr_In->row, Tsr_In->col, tempTsr.vals[k], temprow, tempcol,
+								filter_height, filter_width, stride, padsize, mode, value, 0, count_include_pad);
 	}
-    
-    return tempTsr;
+	
+	return tempTsr;
 }
@@ -25,8 +25,8 @@
  * @brief Header file for pooling.c
  *
  * Pooling is a method of downsampling the layer in a non-linear fashion.\n
- * Only max-pooling is supported in this implementation as it is the most 
- * common one found in deep learning networks.
+ * Max-pooling, average-pooling and their global variants (one value per layer)
+ * are supported in this implementation.
  * 
  * @author Andriyanto Halim
  * @date 16 May 2018
@@ -48,6 +48,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
+#include <string.h>
 
 #include "vector.h"
 #include "matrix.h"
@@ -62,11 +63,12 @@
  * @param	filter_width
  * @param 	stride
  * @return 	matrix
- * @note	
- * 1. stride value must be more than 0
- * 2. filter height or filter width must be the same to the stride value
+ * @note	stride value must be more than 0
  * 
- * This function performs maxpooling on a matrix and return a smaller output matrix
+ * This function performs maxpooling on a matrix and return a smaller output matrix.\n
+ * The last window of each row/column is cut at the border, e.g. filter size equal to 
+ * stride gives ceil(size/stride) outputs, and every window starts inside the input.
+ * The input matrix is not modified.
  */
 Matrix maxpooling_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride);
 
@@ -77,12 +79,217 @@ Matrix maxpooling_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width,
  * @param	filter_width
  * @param 	stride
  * @return 	tensor
+ * @note	stride value must be more than 0
+ * 
+ * This function performs maxpooling on each layer of a tensor and return a smaller output tensor.\n
+ * The last window of each row/column is cut at the border, e.g. filter size equal to 
+ * stride gives ceil(size/stride) outputs, and every window starts inside the input.
+ * The input tensor is not modified.
+ */
+Tensor maxpooling_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride);
+
+/**
+ * @brief	Maxpooling with padding on matrix
+ * @param 	Mat_In
+ * @param	filter_height
+ * @param	filter_width
+ * @param 	stride
+ * @param	padsize
+ * @return 	matrix
  * @note	
  * 1. stride value must be more than 0
- * 2. filter height or filter width must be the same to the stride value
+ * 2. padsize must be smaller than filter height and filter width
  * 
- * This function performs maxpooling on each layer of a tensor and return a smaller output tensor
+ * This function performs maxpooling with any window size, stride and padding, 
+ * e.g. overlapping 3x3 windows with stride 2.\n
+ * Large windows use the van Herk/Gil-Werman algorithm (see max_filter_2d_Mat_wCPU()).\n
+ * Output size is (size + 2*padsize - filter size)/stride + 1. Padded elements are 
+ * ignored, i.e. each output is the max of the input elements inside its window.
+ * The input matrix is read in place.
  */
-Tensor maxpooling_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride);
+Matrix maxpooling_2d_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride, int padsize);
+
+/**
+ * @brief	Maxpooling with padding on tensor
+ * @param 	Tsr_In
+ * @param	filter_height
+ * @param	filter_width
+ * @param 	stride
+ * @param	padsize
+ * @return 	tensor
+ * @note	
+ * 1. stride value must be more than 0
+ * 2. padsize must be smaller than filter height and filter width
+ * 
+ * This function performs maxpooling_2d_Mat_wCPU() on each layer of a tensor.
+ * Layers are pooled in parallel.
+ */
+Tensor maxpooling_2d_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride, int padsize);
+
+/**
+ * @brief	Average pooling on matrix
+ * @param 	Mat_In
+ * @param	filter_height
+ * @param	filter_width
+ * @param 	stride
+ * @param	padsize
+ * @param	count_include_pad
+ * @return 	matrix
+ * @note	
+ * 1. stride value must be more than 0
+ * 2. padsize must be smaller than filter height and filter width
+ * 
+ * This function performs average pooling with any window size, stride and zero padding.\n
+ * Output size is (size + 2*padsize - filter size)/stride + 1. If count_include_pad is non-zero,
+ * each window sum is divided by filter_height*filter_width, otherwise by the number of
+ * input elements inside the window. The input matrix is read in place.
+ */
+Matrix avgpooling_2d_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride, int padsize, int count_include_pad);
+
+/**
+ * @brief	Average pooling on tensor
+ * @param 	Tsr_In
+ * @param	filter_height
+ * @param	filter_width
+ * @param 	stride
+ * @param	padsize
+ * @param	count_include_pad
+ * @return 	tensor
+ * @note	
+ * 1. stride value must be more than 0
+ * 2. padsize must be smaller than filter height and filter width
+ * 
+ * This function performs avgpooling_2d_Mat_wCPU() on each layer of a tensor.
+ * Layers are pooled in parallel.
+ */
+Tensor avgpooling_2d_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride, int padsize, int count_include_pad);
+
+/**
+ * @brief	Global average pooling on tensor
+ * @param 	Tsr_In
+ * @return 	Vector
+ * 
+ * This function calculates the average of each tensor layer in a single pass and 
+ * return a vector with tensor's depth as its length.
+ */
+Vector global_avgpooling_Tsr_wCPU(Tensor *Tsr_In);
+
+/**
+ * @brief	Global max pooling on tensor
+ * @param 	Tsr_In
+ * @return 	Vector
+ * 
+ * This function finds the max value of each tensor layer in a single pass and 
+ * return a vector with tensor's depth as its length.
+ */
+Vector global_maxpooling_Tsr_wCPU(Tensor *Tsr_In);
+
+/**
+ * @brief	Max filter on matrix
+ * @param 	Mat_In
+ * @param	filter_height
+ * @param	filter_width
+ * @return 	matrix
+ * @note	filter size must not be larger than the matrix
+ * 
+ * This function returns the max of every filter_height x filter_width window (stride 1,
+ * no padding), also known as grayscale morphological dilation.\n
+ * It uses the separable van Herk/Gil-Werman algorithm, which needs about 3 comparisons
+ * per element and direction regardless of window size.
+ */
+Matrix max_filter_2d_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width);
+
+/**
+ * @brief	Max filter on tensor
+ * @param 	Tsr_In
+ * @param	filter_height
+ * @param	filter_width
+ * @return 	tensor
+ * @note	filter size must not be larger than the tensor's layers
+ * 
+ * This function performs max_filter_2d_Mat_wCPU() on each layer of a tensor
+ */
+Tensor max_filter_2d_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width);
+
+/**
+ * @brief	Maxpooling with border mode on matrix
+ * @param 	Mat_In
+ * @param	filter_height
+ * @param	filter_width
+ * @param 	stride
+ * @param	padsize
+ * @param	mode
+ * @param	value
+ * @return 	matrix
+ * @note	
+ * 1. stride value must be more than 0
+ * 2. padsize must not be negative and must be smaller than filter height and filter width
+ * 
+ * This function performs maxpooling on the input matrix extended by padsize elements on
+ * every side, where the extension is resolved on the fly by the border mode (value is the
+ * constant used by BORDER_CONSTANT). The input matrix is neither modified nor copied.
+ */
+Matrix maxpooling_2d_with_border_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride, int padsize, Border_Mode mode, float value);
+
+/**
+ * @brief	Maxpooling with border mode on tensor
+ * @param 	Tsr_In
+ * @param	filter_height
+ * @param	filter_width
+ * @param 	stride
+ * @param	padsize
+ * @param	mode
+ * @param	value
+ * @return 	tensor
+ * @note	
+ * 1. stride value must be more than 0
+ * 2. padsize must not be negative and must be smaller than filter height and filter width
+ * 
+ * This function performs maxpooling_2d_with_border_Mat_wCPU() on each layer of a tensor.
+ */
+Tensor maxpooling_2d_with_border_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride, int padsize, Border_Mode mode, float value);
+
+/**
+ * @brief	Average pooling with border mode on matrix
+ * @param 	Mat_In
+ * @param	filter_height
+ * @param	filter_width
+ * @param 	stride
+ * @param	padsize
+ * @param	mode
+ * @param	value
+ * @param	count_include_pad
+ * @return 	matrix
+ * @note	
+ * 1. stride value must be more than 0
+ * 2. padsize must not be negative and must be smaller than filter height and filter width
+ * 
+ * This function performs average pooling on the input matrix extended by padsize elements on
+ * every side, where the extension is resolved on the fly by the border mode (value is the
+ * constant used by BORDER_CONSTANT). If count_include_pad is non-zero, the border elements
+ * take part in the average and each window sum is divided by filter_height*filter_width,
+ * otherwise only the input elements inside the window are averaged, whatever the border mode.
+ * The input matrix is neither modified nor copied.
+ */
+Matrix avgpooling_2d_with_border_Mat_wCPU(Matrix *Mat_In, int filter_height, int filter_width, int stride, int padsize, Border_Mode mode, float value, int count_include_pad);
+
+/**
+ * @brief	Average pooling with border mode on tensor
+ * @param 	Tsr_In
+ * @param	filter_height
+ * @param	filter_width
+ * @param 	stride
+ * @param	padsize
+ * @param	mode
+ * @param	value
+ * @param	count_include_pad
+ * @return 	tensor
+ * @note	
+ * 1. stride value must be more than 0
+ * 2. padsize must not be negative and must be smaller than filter height and filter width
+ * 
+ * This function performs avgpooling_2d_with_border_Mat_wCPU() on each layer of a tensor.
+ */
+Tensor avgpooling_2d_with_border_Tsr_wCPU(Tensor *Tsr_In, int filter_height, int filter_width, int stride, int padsize, Border_Mode mode, float value, int count_include_pad);
 
 #endif /* POOLING_H */
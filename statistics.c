@@ -42,183 +42,441 @@
  */
  
 #include "statistics.h"
+#include "internal.h"
+
+// Elements are folded MOMENTS_LANES at a time with Welford updates in float over blocks
+// of MOMENTS_BLOCK elements, then lanes and blocks are combined in double by
+// merge_moments, which keeps rounding bounded by the block size. 32 lanes keep the
+// lane loop from being fully unrolled, so it is vectorized (min/max included).
+#define MOMENTS_LANES 32
+#define MOMENTS_BLOCK (32*MOMENTS_LANES)
+
+static Moments moments_row(const float *vals, int len)
+{
+	Moments tempMom = create_moments();
+	
+	for (int b = 0; b < len; b += MOMENTS_BLOCK)
+	{
+		int blocklen = (len - b < MOMENTS_BLOCK) ? len - b : MOMENTS_BLOCK;
+		int steps = blocklen / MOMENTS_LANES;
+		
+		float lanemean[MOMENTS_LANES], lanem2[MOMENTS_LANES];
+		float lanemin[MOMENTS_LANES], lanemax[MOMENTS_LANES];
+		
+		for (int l = 0; l < MOMENTS_LANES; l++)
+		{
+			lanemean[l] = 0.0f;
+			lanem2[l] = 0.0f;
+			lanemin[l] = INFINITY;
+			lanemax[l] = -INFINITY;
+		}
+		
+		for (int t = 0; t < steps; t++)
+		{
+			const float *x = vals + b + t*MOMENTS_LANES;
+			float inv = 1.0f/(t + 1);
+			
+			for (int l = 0; l < MOMENTS_LANES; l++)
+			{
+				float delta = x[l] - lanemean[l];
+				
+				lanemean[l] += delta*inv;
+				lanem2[l] += delta*(x[l] - lanemean[l]);
+				lanemin[l] = (x[l] < lanemin[l]) ? x[l] : lanemin[l];
+				lanemax[l] = (x[l] > lanemax[l]) ? x[l] : lanemax[l];
+			}
+		}
+		
+		for (int l = 0; l < MOMENTS_LANES && steps > 0; l++)
+		{
+			Moments laneMom = {steps, lanemean[l], lanem2[l], lanemin[l], lanemax[l]};
+			
+			merge_moments(&tempMom, &laneMom);
+		}
+		
+		// Remaining elements of the last block, one at a time
+		for (int j = b + steps*MOMENTS_LANES; j < b + blocklen; j++)
+		{
+			Moments oneMom = {1, vals[j], 0.0, vals[j], vals[j]};
+			
+			merge_moments(&tempMom, &oneMom);
+		}
+	}
+	
+	return tempMom;
+}
+
+// Sample variance, as used throughout this file, NAN for fewer than two values
+static float moments_variance(Moments *Mom)
+{
+	return (Mom->count > 1) ? (float)(Mom->M2/(Mom->count - 1)) : NAN;
+}
+
+// Write (x - mean)/sqrt(var + eps) of one row
+static void normalization_row(const float *in, float *out, int len, float mean, float invstd)
+{
+	for (int j = 0; j < len; j++)
+	{
+		out[j] = (in[j] - mean)*invstd;
+	}
+}
+
+// Write (x - mean)*invstd*gamma[j] + beta[j] of one row in a single pass, gamma and beta
+// are optional
+static void normalization_affine_row(const float *in, float *out, int len, float mean, float invstd,
+									 const float *gamma, const float *beta)
+{
+	if (gamma != NULL && beta != NULL)
+	{
+		for (int j = 0; j < len; j++)
+		{
+			out[j] = (in[j] - mean)*invstd*gamma[j] + beta[j];
+		}
+	}
+	else if (gamma != NULL)
+	{
+		for (int j = 0; j < len; j++)
+		{
+			out[j] = (in[j] - mean)*invstd*gamma[j];
+		}
+	}
+	else if (beta != NULL)
+	{
+		for (int j = 0; j < len; j++)
+		{
+			out[j] = (in[j] - mean)*invstd + beta[j];
+		}
+	}
+	else
+	{
+		normalization_row(in, out, len, mean, invstd);
+	}
+}
+
+// Sum of squares of one row, in float lanes combined in double
+static double sum_squares_row(const float *vals, int len)
+{
+	float lanesum[MOMENTS_LANES] = {0};
+	int steps = len/MOMENTS_LANES;
+	
+	for (int t = 0; t < steps; t++)
+	{
+		for (int l = 0; l < MOMENTS_LANES; l++)
+		{
+			float x = vals[t*MOMENTS_LANES + l];
+			
+			lanesum[l] += x*x;
+		}
+	}
+	
+	double tempsum = 0;
+	
+	for (int l = 0; l < MOMENTS_LANES; l++)
+	{
+		tempsum += lanesum[l];
+	}
+	
+	for (int j = steps*MOMENTS_LANES; j < len; j++)
+	{
+		tempsum += (double)vals[j]*vals[j];
+	}
+	
+	return tempsum;
+}
+
+Moments create_moments(void)
+{
+	Moments tempMom = {0, 0.0, 0.0, INFINITY, -INFINITY};
+	
+	return tempMom;
+}
+
+void merge_moments(Moments *Mom_Acc, Moments *Mom_In)
+{
+	if (Mom_In->count == 0)
+	{
+		return;
+	}
+	
+	long long count = Mom_Acc->count + Mom_In->count;
+	double delta = Mom_In->mean - Mom_Acc->mean;
+	double weight = (double)Mom_In->count/count;
+	
+	// Chan et al. pairwise update
+	Mom_Acc->M2 += Mom_In->M2 + delta*delta*Mom_Acc->count*weight;
+	Mom_Acc->mean += delta*weight;
+	Mom_Acc->count = count;
+	
+	Mom_Acc->min = (Mom_In->min < Mom_Acc->min) ? Mom_In->min : Mom_Acc->min;
+	Mom_Acc->max = (Mom_In->max > Mom_Acc->max) ? Mom_In->max : Mom_Acc->max;
+}
+
+// Reduction of one part in REDUCE_LANES lanes, parts are merged by reduce_tree()
+static double sum_chunk(const float *vals, int len)
+{
+	float lanesum[REDUCE_LANES] = {0};
+	int steps = len/REDUCE_LANES;
+	
+	for (int t = 0; t < steps; t++)
+	{
+		for (int l = 0; l < REDUCE_LANES; l++)
+		{
+			lanesum[l] += vals[t*REDUCE_LANES + l];
+		}
+	}
+	
+	double tempsum = 0;
+	
+	for (int l = 0; l < REDUCE_LANES; l++)
+	{
+		tempsum += lanesum[l];
+	}
+	
+	for (int j = steps*REDUCE_LANES; j < len; j++)
+	{
+		tempsum += vals[j];
+	}
+	
+	return tempsum;
+}
+
+static float max_chunk(const float *vals, int len)
+{
+	float lanemax[REDUCE_LANES];
+	int steps = len/REDUCE_LANES;
+	
+	for (int l = 0; l < REDUCE_LANES; l++)
+	{
+		lanemax[l] = -INFINITY;
+	}
+	
+	for (int t = 0; t < steps; t++)
+	{
+		for (int l = 0; l < REDUCE_LANES; l++)
+		{
+			float x = vals[t*REDUCE_LANES + l];
+			
+			lanemax[l] = (x > lanemax[l]) ? x : lanemax[l];
+		}
+	}
+	
+	float tempmax = -INFINITY;
+	
+	for (int l = 0; l < REDUCE_LANES; l++)
+	{
+		tempmax = (lanemax[l] > tempmax) ? lanemax[l] : tempmax;
+	}
+	
+	for (int j = steps*REDUCE_LANES; j < len; j++)
+	{
+		tempmax = (vals[j] > tempmax) ? vals[j] : tempmax;
+	}
+	
+	return tempmax;
+}
+
+static void sum_part(const void *ctx, long part, void *partial)
+{
+	int len;
+	const float *vals = reduce_part(ctx, part, &len);
+	
+	*(double *)partial = sum_chunk(vals, len);
+}
+
+static void sum_merge(void *partial, const void *other)
+{
+	*(double *)partial += *(const double *)other;
+}
+
+static void max_part(const void *ctx, long part, void *partial)
+{
+	int len;
+	const float *vals = reduce_part(ctx, part, &len);
+	
+	*(float *)partial = max_chunk(vals, len);
+}
+
+static void max_merge(void *partial, const void *other)
+{
+	float x = *(const float *)other;
+	
+	*(float *)partial = (x > *(float *)partial) ? x : *(float *)partial;
+}
+
+static void moments_part(const void *ctx, long part, void *partial)
+{
+	int len;
+	const float *vals = reduce_part(ctx, part, &len);
+	
+	*(Moments *)partial = moments_row(vals, len);
+}
+
+static void moments_merge(void *partial, const void *other)
+{
+	Moments tempMom = *(const Moments *)other;
+	
+	merge_moments(partial, &tempMom);
+}
+
+// Whole-object reductions, the source is released
+static double sum_source(Reduce_Source *Src)
+{
+	double tempsum = 0;
+	
+	reduce_tree(reduce_parts(Src), sizeof(double), sum_part, sum_merge, Src, &tempsum);
+	free_reduce_source(Src);
+	
+	return tempsum;
+}
+
+static float max_source(Reduce_Source *Src)
+{
+	float tempmax = -INFINITY;
+	
+	reduce_tree(reduce_parts(Src), sizeof(float), max_part, max_merge, Src, &tempmax);
+	free_reduce_source(Src);
+	
+	return tempmax;
+}
+
+static Moments moments_source(Reduce_Source *Src)
+{
+	Moments tempMom = create_moments();
+	
+	reduce_tree(reduce_parts(Src), sizeof(Moments), moments_part, moments_merge, Src, &tempMom);
+	free_reduce_source(Src);
+	
+	return tempMom;
+}
+
+float sum_Vec_wCPU(Vector *Vec_In)
+{
+	Reduce_Source tempSrc = reduce_source_Vec(Vec_In);
+	
+	return (float)sum_source(&tempSrc);
+}
+
+float sum_Mat_wCPU(Matrix *Mat_In)
+{
+	Reduce_Source tempSrc = reduce_source_Mat(Mat_In, 1);
+	
+	return (float)sum_source(&tempSrc);
+}
+
+float sum_Tsr_wCPU(Tensor *Tsr_In)
+{
+	Reduce_Source tempSrc = reduce_source_Tsr(Tsr_In, 1);
+	
+	return (float)sum_source(&tempSrc);
+}
 
 float mean_Vec_wCPU(Vector *Vec_In)
 {
-	float tempsum = 0;
-    
-    for (int i = 0; i < Vec_In->len; i++)
-    {
-		tempsum += Vec_In->vals[i];
-    }
-    
-    return tempsum/Vec_In->len;
+	Reduce_Source tempSrc = reduce_source_Vec(Vec_In);
+	
+	return (float)(sum_source(&tempSrc)/tempSrc.count);
 }
 
 float mean_Mat_wCPU(Matrix *Mat_In)
 {
-    float tempsum = 0;
-    
-    for (int i = 0; i < Mat_In->row; i++)
-    {
-        for(int j = 0; j < Mat_In->col; j++)
-        {
-            tempsum += Mat_In->vals[i][j];
-        }
-    }
-    
-    return tempsum/(Mat_In->row * Mat_In->col);
+	Reduce_Source tempSrc = reduce_source_Mat(Mat_In, 1);
+	
+	return (float)(sum_source(&tempSrc)/tempSrc.count);
 }
 
 float mean_Tsr_wCPU(Tensor *Tsr_In)
 {
-	float tempsum = 0;
-    
-    for (int k = 0; k < Tsr_In->depth; k++)
-    {
-		for (int i = 0; i < Tsr_In->row; i++)
-		{
-			for(int j = 0; j < Tsr_In->col; j++)
-			{
-				tempsum += Tsr_In->vals[k][i][j];
-			}
-		}
-    }
-    
-    return tempsum/(Tsr_In->row * Tsr_In->col * Tsr_In->depth);
+	Reduce_Source tempSrc = reduce_source_Tsr(Tsr_In, 1);
+	
+	return (float)(sum_source(&tempSrc)/tempSrc.count);
+}
+
+float max_Vec_wCPU(Vector *Vec_In)
+{
+	Reduce_Source tempSrc = reduce_source_Vec(Vec_In);
+	
+	return max_source(&tempSrc);
+}
+
+float max_Mat_wCPU(Matrix *Mat_In)
+{
+	Reduce_Source tempSrc = reduce_source_Mat(Mat_In, 1);
+	
+	return max_source(&tempSrc);
+}
+
+float max_Tsr_wCPU(Tensor *Tsr_In)
+{
+	Reduce_Source tempSrc = reduce_source_Tsr(Tsr_In, 1);
+	
+	return max_source(&tempSrc);
+}
+
+Moments moments_Vec_wCPU(Vector *Vec_In)
+{
+	Reduce_Source tempSrc = reduce_source_Vec(Vec_In);
+	
+	return moments_source(&tempSrc);
+}
+
+Moments moments_Mat_wCPU(Matrix *Mat_In)
+{
+	Reduce_Source tempSrc = reduce_source_Mat(Mat_In, 1);
+	
+	return moments_source(&tempSrc);
+}
+
+Moments moments_Tsr_wCPU(Tensor *Tsr_In)
+{
+	Reduce_Source tempSrc = reduce_source_Tsr(Tsr_In, 1);
+	
+	return moments_source(&tempSrc);
 }
 
 float variance_Vec_wCPU(Vector *Vec_In)
 {
-    float tempsumofsqrdiff = 0;
-    float tempmean = 0;
-    float tempVecsize = Vec_In->len;
-    
-    tempmean = mean_Vec_wCPU(Vec_In);
-    
-    for(int i = 0; i < Vec_In->len; i++)
-    {
-		tempsumofsqrdiff += pow((Vec_In->vals[i] - tempmean), 2);
-    }
-    
-    return tempsumofsqrdiff/(tempVecsize - 1);	
+	Moments tempMom = moments_Vec_wCPU(Vec_In);
+	
+	return moments_variance(&tempMom);
 }
 
 float variance_Mat_wCPU(Matrix *Mat_In)
 {
-    float tempsumofsqrdiff = 0;
-    float tempmean = 0;
-    float tempMatsize = Mat_In->row * Mat_In->col;
-    
-    tempmean = mean_Mat_wCPU(Mat_In);
-    
-    for(int i = 0; i < Mat_In->row; i++)
-    {
-        for(int j = 0; j < Mat_In->col; j++)
-        {
-            tempsumofsqrdiff += pow((Mat_In->vals[i][j] - tempmean), 2);
-        }
-    }
-    
-    return tempsumofsqrdiff/(tempMatsize - 1);
+	Moments tempMom = moments_Mat_wCPU(Mat_In);
+	
+	return moments_variance(&tempMom);
 }
 
 float variance_Tsr_wCPU(Tensor *Tsr_In)
 {
-	float tempsumofsqrdiff = 0;
-    float tempmean = 0;
-    float tempTsrsize = Tsr_In->row * Tsr_In->col * Tsr_In->depth;
-    
-    tempmean = mean_Tsr_wCPU(Tsr_In);
-    
-    for(int k = 0; k < Tsr_In->depth; k++)
-    {
-		for(int i = 0; i < Tsr_In->row; i++)
-		{
-			for(int j = 0; j < Tsr_In->col; j++)
-			{
-				tempsumofsqrdiff += pow((Tsr_In->vals[k][i][j] - tempmean), 2);
-			}
-		}
-	}
-    
-    return tempsumofsqrdiff/(tempTsrsize - 1);
+	Moments tempMom = moments_Tsr_wCPU(Tsr_In);
+	
+	return moments_variance(&tempMom);
 }
 
 float std_dev_Vec_wCPU(Vector *Vec_In)
 {
-	float tempsumofsqrdiff = 0;
-    float tempmean = 0;
-    
-    float tempMatsize = Vec_In->len;
-    
-    tempmean = mean_Vec_wCPU(Vec_In);
-    
-	for(int i = 0; i < Vec_In->len; i++)
-    {
-		tempsumofsqrdiff += pow((Vec_In->vals[i] - tempmean), 2);
-    }
-    
-    return sqrt(tempsumofsqrdiff/((tempMatsize) - 1));
+	return sqrtf(variance_Vec_wCPU(Vec_In));
 }
 
 float std_dev_Mat_wCPU(Matrix *Mat_In)
 {
-    float tempsumofsqrdiff = 0;
-    float tempmean = 0;
-    
-    float tempMatsize = Mat_In->row * Mat_In->col;
-    
-    tempmean = mean_Mat_wCPU(Mat_In);
-    
-    for(int i = 0; i < Mat_In->row; i++)
-    {
-        for(int j = 0; j < Mat_In->col; j++)
-        {
-            tempsumofsqrdiff += pow((Mat_In->vals[i][j] - tempmean), 2);
-        }
-    }
-    
-    return sqrt(tempsumofsqrdiff/((tempMatsize) - 1));
+	return sqrtf(variance_Mat_wCPU(Mat_In));
 }
 
 float std_dev_Tsr_wCPU(Tensor *Tsr_In)
 {
-	float tempsumofsqrdiff = 0;
-    float tempmean = 0;
-    
-    float tempTsrsize = Tsr_In->row * Tsr_In->col * Tsr_In->depth;
-    
-    tempmean = mean_Tsr_wCPU(Tsr_In);
-    
-    for(int k = 0; k < Tsr_In->depth; k++)
-    {
-		for(int i = 0; i < Tsr_In->row; i++)
-		{
-			for(int j = 0; j < Tsr_In->col; j++)
-			{
-				tempsumofsqrdiff += pow((Tsr_In->vals[k][i][j] - tempmean), 2);
-			}
-		}
-    }
-    
-    return sqrt(tempsumofsqrdiff/((tempTsrsize) - 1));
+	return sqrtf(variance_Tsr_wCPU(Tsr_In));
 }
 
 Vector normalization_Vec_wCPU(Vector *Vec_In)
 {
 	Vector tempVec = create_vector(Vec_In->len);
 	
-	float tempmean = 0;
-    float tempvariance = 0;
-    
-    tempmean = mean_Vec_wCPU(Vec_In);
-    tempvariance = variance_Vec_wCPU(Vec_In);
-    
-	for(int i = 0; i < Vec_In->len; i++)
-	{
-		tempVec.vals[i] = (Vec_In->vals[i] - tempmean)/sqrt(tempvariance + 0.0000001f);
-	}
+	Moments tempMom = moments_Vec_wCPU(Vec_In);
+	float invstd = 1.0f/sqrtf(moments_variance(&tempMom) + 0.0000001f);
+	
+	normalization_row(Vec_In->vals, tempVec.vals, Vec_In->len, (float)tempMom.mean, invstd);
 
     return tempVec;
 }
@@ -227,18 +485,12 @@ Matrix normalization_Mat_wCPU(Matrix *Mat_In)
 {
     Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
     
-    float tempmean = 0;
-    float tempvariance = 0;
-    
-    tempmean = mean_Mat_wCPU(Mat_In);
-    tempvariance = variance_Mat_wCPU(Mat_In);
+    Moments tempMom = moments_Mat_wCPU(Mat_In);
+	float invstd = 1.0f/sqrtf(moments_variance(&tempMom) + 0.0000001f);
     
     for(int i = 0; i < Mat_In->row; i++)
     {
-        for(int j = 0; j < Mat_In->col; j++)
-        {
-            tempMat.vals[i][j] = (Mat_In->vals[i][j] - tempmean)/sqrt(tempvariance + 0.0000001f);
-        }
+		normalization_row(Mat_In->vals[i], tempMat.vals[i], Mat_In->col, (float)tempMom.mean, invstd);
     }
     
     return tempMat;
@@ -248,22 +500,1061 @@ Tensor normalization_Tsr_wCPU(Tensor *Tsr_In)
 {
     Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
     
-    float tempmean = 0;
-    float tempvariance = 0;
-    
-    tempmean = mean_Tsr_wCPU(Tsr_In);
-    tempvariance = variance_Tsr_wCPU(Tsr_In);
+    Moments tempMom = moments_Tsr_wCPU(Tsr_In);
+	float invstd = 1.0f/sqrtf(moments_variance(&tempMom) + 0.0000001f);
     
     for(int k = 0; k < Tsr_In->depth; k++)
     {
 		for(int i = 0; i < Tsr_In->row; i++)
 		{
-			for(int j = 0; j < Tsr_In->col; j++)
-			{
-				tempTsr.vals[k][i][j] = (Tsr_In->vals[k][i][j] - tempmean)/sqrt(tempvariance + 0.0000001f);
-			}
+			normalization_row(Tsr_In->vals[k][i], tempTsr.vals[k][i], Tsr_In->col, (float)tempMom.mean, invstd);
 		}
     }
     
     return tempTsr;
 }
+
+Tensor batchnorm_Tsr_wCPU(Tensor *Tsr_In, Vector *Vec_Gamma, Vector *Vec_Beta, Vector *Vec_Mean, Vector *Vec_Var, float eps)
+{
+	assert(Tsr_In->depth > 0);
+	assert(Vec_Mean->len == Tsr_In->depth && Vec_Var->len == Tsr_In->depth);
+	assert(Vec_Gamma == NULL || Vec_Gamma->len == Tsr_In->depth);
+	assert(Vec_Beta == NULL || Vec_Beta->len == Tsr_In->depth);
+	
+	Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
+	
+	// gamma*(x - mean)/sqrt(var + eps) + beta folded into x*scale + shift per channel
+	float *scale = malloc(Tsr_In->depth*sizeof(float));
+	float *shift = malloc(Tsr_In->depth*sizeof(float));
+	assert(scale != NULL && shift != NULL);
+	
+	for (int k = 0; k < Tsr_In->depth; k++)
+	{
+		float gamma = (Vec_Gamma != NULL) ? Vec_Gamma->vals[k] : 1.0f;
+		float beta = (Vec_Beta != NULL) ? Vec_Beta->vals[k] : 0.0f;
+		
+		scale[k] = gamma/sqrtf(Vec_Var->vals[k] + eps);
+		shift[k] = beta - Vec_Mean->vals[k]*scale[k];
+	}
+	
+	// Rows of all channels are independent
+	int rows = Tsr_In->depth*Tsr_In->row;
+	
+	#pragma omp parallel for
+	for (int r = 0; r < rows; r++)
+	{
+		int k = r/Tsr_In->row;
+		int i = r%Tsr_In->row;
+		
+		const float *in = Tsr_In->vals[k][i];
+		float *out = tempTsr.vals[k][i];
+		
+		for (int j = 0; j < Tsr_In->col; j++)
+		{
+			out[j] = in[j]*scale[k] + shift[k];
+		}
+	}
+	
+	free(scale);
+	free(shift);
+	
+	return tempTsr;
+}
+
+Matrix layernorm_Mat_wCPU(Matrix *Mat_In, Vector *Vec_Gamma, Vector *Vec_Beta, float eps)
+{
+	assert(Vec_Gamma == NULL || Vec_Gamma->len == Mat_In->col);
+	assert(Vec_Beta == NULL || Vec_Beta->len == Mat_In->col);
+	
+	Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
+	
+	const float *gamma = (Vec_Gamma != NULL) ? Vec_Gamma->vals : NULL;
+	const float *beta = (Vec_Beta != NULL) ? Vec_Beta->vals : NULL;
+	
+	// Each row is read once for its moments and once more from cache to write the output
+	#pragma omp parallel for
+	for (int i = 0; i < Mat_In->row; i++)
+	{
+		Moments rowMom = moments_row(Mat_In->vals[i], Mat_In->col);
+		float invstd = 1.0f/sqrtf((float)(rowMom.M2/Mat_In->col) + eps);
+		
+		normalization_affine_row(Mat_In->vals[i], tempMat.vals[i], Mat_In->col, (float)rowMom.mean, invstd, gamma, beta);
+	}
+	
+	return tempMat;
+}
+
+Matrix rmsnorm_Mat_wCPU(Matrix *Mat_In, Vector *Vec_Gamma, float eps)
+{
+	assert(Vec_Gamma == NULL || Vec_Gamma->len == Mat_In->col);
+	
+	Matrix tempMat = create_matrix(Mat_In->row, Mat_In->col);
+	
+	const float *gamma = (Vec_Gamma != NULL) ? Vec_Gamma->vals : NULL;
+	
+	#pragma omp parallel for
+	for (int i = 0; i < Mat_In->row; i++)
+	{
+		const float *in = Mat_In->vals[i];
+		float *out = tempMat.vals[i];
+		float invrms = 1.0f/sqrtf((float)(sum_squares_row(in, Mat_In->col)/Mat_In->col) + eps);
+		
+		// No mean to subtract, one pass scales the row
+		if (gamma != NULL)
+		{
+			for (int j = 0; j < Mat_In->col; j++)
+			{
+				out[j] = in[j]*invrms*gamma[j];
+			}
+		}
+		else
+		{
+			for (int j = 0; j < Mat_In->col; j++)
+			{
+				out[j] = in[j]*invrms;
+			}
+		}
+	}
+	
+	return tempMat;
+}
+
+Tensor layernorm_Tsr_wCPU(Tensor *Tsr_In, Vector *Vec_Gamma, Vector *Vec_Beta, float eps)
+{
+	assert(Vec_Gamma == NULL || Vec_Gamma->len == Tsr_In->depth);
+	assert(Vec_Beta == NULL || Vec_Beta->len == Tsr_In->depth);
+	
+	Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
+	
+	int depth = Tsr_In->depth;
+	int col = Tsr_In->col;
+	
+	// Every pixel is normalized across channels. A whole row of pixels is processed at
+	// once, so channels are walked row by row and the loops over columns vectorize.
+	#pragma omp parallel
+	{
+		float *mean = malloc(col*sizeof(float));
+		float *m2 = malloc(col*sizeof(float));
+		assert(mean != NULL && m2 != NULL);
+		
+		#pragma omp for
+		for (int i = 0; i < Tsr_In->row; i++)
+		{
+			for (int j = 0; j < col; j++)
+			{
+				mean[j] = 0.0f;
+				m2[j] = 0.0f;
+			}
+			
+			// Welford across channels
+			for (int k = 0; k < depth; k++)
+			{
+				const float *in = Tsr_In->vals[k][i];
+				float inv = 1.0f/(k + 1);
+				
+				for (int j = 0; j < col; j++)
+				{
+					float delta = in[j] - mean[j];
+					
+					mean[j] += delta*inv;
+					m2[j] += delta*(in[j] - mean[j]);
+				}
+			}
+			
+			// m2 now holds the inverse standard deviation
+			for (int j = 0; j < col; j++)
+			{
+				m2[j] = 1.0f/sqrtf(m2[j]/depth + eps);
+			}
+			
+			for (int k = 0; k < depth; k++)
+			{
+				const float *in = Tsr_In->vals[k][i];
+				float *out = tempTsr.vals[k][i];
+				float gamma = (Vec_Gamma != NULL) ? Vec_Gamma->vals[k] : 1.0f;
+				float beta = (Vec_Beta != NULL) ? Vec_Beta->vals[k] : 0.0f;
+				
+				for (int j = 0; j < col; j++)
+				{
+					out[j] = (in[j] - mean[j])*m2[j]*gamma + beta;
+				}
+			}
+		}
+		
+		free(mean);
+		free(m2);
+	}
+	
+	return tempTsr;
+}
+
+Tensor rmsnorm_Tsr_wCPU(Tensor *Tsr_In, Vector *Vec_Gamma, float eps)
+{
+	assert(Vec_Gamma == NULL || Vec_Gamma->len == Tsr_In->depth);
+	
+	Tensor tempTsr = create_tensor(Tsr_In->row, Tsr_In->col, Tsr_In->depth);
+	
+	int depth = Tsr_In->depth;
+	int col = Tsr_In->col;
+	
+	// Same traversal as layernorm_Tsr_wCPU()
+	#pragma omp parallel
+	{
+		float *invrms = malloc(col*sizeof(float));
+		assert(invrms != NULL);
+		
+		#pragma omp for
+		for (int i = 0; i < Tsr_In->row; i++)
+		{
+			for (int j = 0; j < col; j++)
+			{
+				invrms[j] = 0.0f;
+			}
+			
+			for (int k = 0; k < depth; k++)
+			{
+				const float *in = Tsr_In->vals[k][i];
+				
+				for (int j = 0; j < col; j++)
+				{
+					invrms[j] += in[j]*in[j];
+				}
+			}
+			
+			for (int j = 0; j < col; j++)
+			{
+				invrms[j] = 1.0f/sqrtf(invrms[j]/depth + eps);
+			}
+			
+			for (int k = 0; k < depth; k++)
+			{
+				const float *in = Tsr_In->vals[k][i];
+				float *out = tempTsr.vals[k][i];
+				float gamma = (Vec_Gamma != NULL) ? Vec_Gamma->vals[k] : 1.0f;
+				
+				for (int j = 0; j < col; j++)
+				{
+					out[j] = in[j]*invrms[j]*gamma;
+				}
+			}
+		}
+		
+		free(invrms);
+	}
+	
+	return tempTsr;
+}
+
+Stats_Accumulator create_stats_accumulator(int channels)
+{
+	assert(channels > 0);
+	
+	Stats_Accumulator tempAcc;
+	
+	tempAcc.channels = channels;
+	tempAcc.moments = malloc(channels*sizeof(Moments));
+	assert(tempAcc.moments != NULL);
+	
+	reset_stats_accumulator(&tempAcc);
+	
+	return tempAcc;
+}
+
+void reset_stats_accumulator(Stats_Accumulator *Acc)
+{
+	for (int k = 0; k < Acc->channels; k++)
+	{
+		Acc->moments[k] = create_moments();
+	}
+}
+
+void free_stats_accumulator(Stats_Accumulator *Acc)
+{
+	free(Acc->moments);
+	Acc->moments = NULL;
+	Acc->channels = 0;
+}
+
+void merge_stats_accumulator(Stats_Accumulator *Acc, Stats_Accumulator *Acc_In)
+{
+	assert(Acc->channels == Acc_In->channels);
+	
+	for (int k = 0; k < Acc->channels; k++)
+	{
+		merge_moments(&Acc->moments[k], &Acc_In->moments[k]);
+	}
+}
+
+void accumulate_Vec_wCPU(Stats_Accumulator *Acc, Vector *Vec_In)
+{
+	if (Acc->channels == 1)
+	{
+		Moments tempMom = moments_Vec_wCPU(Vec_In);
+		
+		merge_moments(&Acc->moments[0], &tempMom);
+		return;
+	}
+	
+	assert(Acc->channels == Vec_In->len);
+	
+	for (int j = 0; j < Vec_In->len; j++)
+	{
+		Moments oneMom = {1, Vec_In->vals[j], 0.0, Vec_In->vals[j], Vec_In->vals[j]};
+		
+		merge_moments(&Acc->moments[j], &oneMom);
+	}
+}
+
+void accumulate_Mat_wCPU(Stats_Accumulator *Acc, Matrix *Mat_In)
+{
+	if (Acc->channels == 1)
+	{
+		Moments tempMom = moments_Mat_wCPU(Mat_In);
+		
+		merge_moments(&Acc->moments[0], &tempMom);
+		return;
+	}
+	
+	assert(Acc->channels == Mat_In->col);
+	
+	if (Mat_In->row == 0)
+	{
+		return;
+	}
+	
+	int col = Mat_In->col;
+	
+	double *mean = calloc(col, sizeof(double));
+	double *m2 = calloc(col, sizeof(double));
+	float *min = malloc(col*sizeof(float));
+	float *max = malloc(col*sizeof(float));
+	assert(mean != NULL && m2 != NULL && min != NULL && max != NULL);
+	
+	for (int j = 0; j < col; j++)
+	{
+		min[j] = INFINITY;
+		max[j] = -INFINITY;
+	}
+	
+	// Welford down the rows of the chunk, all columns at once
+	for (int i = 0; i < Mat_In->row; i++)
+	{
+		const float *x = Mat_In->vals[i];
+		double inv = 1.0/(i + 1);
+		
+		for (int j = 0; j < col; j++)
+		{
+			double delta = x[j] - mean[j];
+			
+			mean[j] += delta*inv;
+			m2[j] += delta*(x[j] - mean[j]);
+			min[j] = (x[j] < min[j]) ? x[j] : min[j];
+			max[j] = (x[j] > max[j]) ? x[j] : max[j];
+		}
+	}
+	
+	for (int j = 0; j < col; j++)
+	{
+		Moments colMom = {Mat_In->row, mean[j], m2[j], min[j], max[j]};
+		
+		merge_moments(&Acc->moments[j], &colMom);
+	}
+	
+	free(mean);
+	free(m2);
+	free(min);
+	free(max);
+}
+
+void accumulate_Tsr_wCPU(Stats_Accumulator *Acc, Tensor *Tsr_In)
+{
+	if (Acc->channels == 1)
+	{
+		Moments tempMom = moments_Tsr_wCPU(Tsr_In);
+		
+		merge_moments(&Acc->moments[0], &tempMom);
+		return;
+	}
+	
+	assert(Acc->channels == Tsr_In->depth);
+	
+	// Every layer is reduced as a matrix
+	for (int k = 0; k < Tsr_In->depth; k++)
+	{
+		Matrix tempLayer = {Tsr_In->row, Tsr_In->col, Tsr_In->vals[k], 1};
+		Reduce_Source tempSrc = reduce_source_Mat(&tempLayer, 1);
+		Moments layerMom = moments_source(&tempSrc);
+		
+		merge_moments(&Acc->moments[k], &layerMom);
+	}
+}
+
+Vector accumulator_mean_wCPU(Stats_Accumulator *Acc)
+{
+	Vector tempVec = create_vector(Acc->channels);
+	
+	for (int k = 0; k < Acc->channels; k++)
+	{
+		tempVec.vals[k] = (Acc->moments[k].count > 0) ? (float)Acc->moments[k].mean : NAN;
+	}
+	
+	return tempVec;
+}
+
+Vector accumulator_variance_wCPU(Stats_Accumulator *Acc)
+{
+	Vector tempVec = create_vector(Acc->channels);
+	
+	for (int k = 0; k < Acc->channels; k++)
+	{
+		tempVec.vals[k] = moments_variance(&Acc->moments[k]);
+	}
+	
+	return tempVec;
+}
+
+Vector accumulator_std_dev_wCPU(Stats_Accumulator *Acc)
+{
+	Vector tempVec = accumulator_variance_wCPU(Acc);
+	
+	for (int k = 0; k < Acc->channels; k++)
+	{
+		tempVec.vals[k] = sqrtf(tempVec.vals[k]);
+	}
+	
+	return tempVec;
+}
+
+Vector accumulator_min_wCPU(Stats_Accumulator *Acc)
+{
+	Vector tempVec = create_vector(Acc->channels);
+	
+	for (int k = 0; k < Acc->channels; k++)
+	{
+		tempVec.vals[k] = Acc->moments[k].min;
+	}
+	
+	return tempVec;
+}
+
+Vector accumulator_max_wCPU(Stats_Accumulator *Acc)
+{
+	Vector tempVec = create_vector(Acc->channels);
+	
+	for (int k = 0; k < Acc->channels; k++)
+	{
+		tempVec.vals[k] = Acc->moments[k].max;
+	}
+	
+	return tempVec;
+}
+
+// Values are binned HISTOGRAM_BLOCK at a time: bin positions of the block are computed
+// in a vectorizable loop, then counted with scalar increments into per-thread counts
+#define HISTOGRAM_BLOCK 256
+
+// Slot of each value in counts of bins + 3: underflow, bins, overflow, NaN (discarded)
+static void histogram_index_block(const float *vals, int len, int *idx, float min, float max, float scale, 
+								  int bins, int absolute)
+{
+	for (int j = 0; j < len; j++)
+	{
+		float x = select_float(absolute, fabsf(vals[j]), vals[j]);
+		int below = x < min;
+		int above = x > max;
+		int inrange = (x >= min) & (x <= max);
+		
+		// Only values in range are converted, the last bin includes max
+		int bin = (int)((select_float(inrange, x, min) - min)*scale);
+		bin = (bin < bins - 1) ? bin : bins - 1;
+		
+		int nan = 1 - (inrange | below | above);
+		
+		// Masks are combined arithmetically, a ?: on a float comparison is not if-converted
+		idx[j] = inrange*(bin + 1) + above*(bins + 1) + nan*(bins + 2);
+	}
+}
+
+// Smallest and largest finite value (or magnitude)
+static void histogram_range_source(const Reduce_Source *Src, int absolute, float *lo, float *hi)
+{
+	float tempmin = INFINITY;
+	float tempmax = -INFINITY;
+	long nparts = reduce_parts(Src);
+	
+	#pragma omp parallel for reduction(min:tempmin) reduction(max:tempmax)
+	for (long c = 0; c < nparts; c++)
+	{
+		int len;
+		const float *vals = reduce_part(Src, c, &len);
+		
+		for (int j = 0; j < len; j++)
+		{
+			float x = absolute ? fabsf(vals[j]) : vals[j];
+			int finite = fabsf(x) <= FLT_MAX;
+			
+			tempmin = (finite && x < tempmin) ? x : tempmin;
+			tempmax = (finite && x > tempmax) ? x : tempmax;
+		}
+	}
+	
+	*lo = tempmin;
+	*hi = tempmax;
+}
+
+// Double the range of an adaptive histogram until it covers [lo, hi], merging pairs of bins
+static void histogram_widen(Histogram *Hist, float lo, float hi)
+{
+	int half = Hist->bins/2;
+	
+	while (lo < Hist->min || hi > Hist->max)
+	{
+		float width = Hist->max - Hist->min;
+		
+		if (hi > Hist->max)
+		{
+			for (int b = 0; b < half; b++)
+			{
+				Hist->counts[b] = Hist->counts[2*b] + Hist->counts[2*b + 1];
+			}
+			
+			memset(Hist->counts + half, 0, (Hist->bins - half)*sizeof(long long));
+			Hist->max = Hist->min + 2*width;
+		}
+		else
+		{
+			for (int b = Hist->bins - 1; b >= half; b--)
+			{
+				Hist->counts[b] = Hist->counts[2*(b - half)] + Hist->counts[2*(b - half) + 1];
+			}
+			
+			memset(Hist->counts, 0, half*sizeof(long long));
+			Hist->min = Hist->max - 2*width;
+		}
+	}
+}
+
+// Count the values of the source into the histogram, the source is released
+static void histogram_source(Histogram *Hist, Reduce_Source *Src)
+{
+	long count = Src->count;
+	
+	if (count == 0)
+	{
+		return;
+	}
+	
+	if (Hist->adaptive)
+	{
+		float lo, hi;
+		
+		histogram_range_source(Src, Hist->absolute, &lo, &hi);
+		
+		if (lo <= hi)
+		{
+			if (Hist->count == 0)
+			{
+				// First data sets the range
+				Hist->min = Hist->absolute ? 0.0f : lo;
+				Hist->max = (hi > Hist->min) ? hi : Hist->min + 1.0f;
+			}
+			
+			histogram_widen(Hist, Hist->absolute ? 0.0f : lo, hi);
+		}
+	}
+	
+	int bins = Hist->bins;
+	float min = Hist->min;
+	float max = Hist->max;
+	float scale = bins/(max - min);
+	long nparts = reduce_parts(Src);
+	
+	long long *total = calloc(bins + 3, sizeof(long long));
+	assert(total != NULL);
+	
+	#pragma omp parallel if (nparts > 1)
+	{
+		long long *local = calloc(bins + 3, sizeof(long long));
+		int idx[HISTOGRAM_BLOCK];
+		
+		#pragma omp for
+		for (long c = 0; c < nparts; c++)
+		{
+			int len;
+			const float *chunk = reduce_part(Src, c, &len);
+			
+			for (int b = 0; b < len; b += HISTOGRAM_BLOCK)
+			{
+				int blocklen = (len - b < HISTOGRAM_BLOCK) ? len - b : HISTOGRAM_BLOCK;
+				
+				histogram_index_block(chunk + b, blocklen, idx, min, max, scale, bins, Hist->absolute);
+				
+				for (int t = 0; t < blocklen; t++)
+				{
+					local[idx[t]]++;
+				}
+			}
+		}
+		
+		// Integer counts, so the merge order does not matter
+		#pragma omp critical
+		for (int b = 0; b < bins + 3; b++)
+		{
+			total[b] += local[b];
+		}
+		
+		free(local);
+	}
+	
+	Hist->underflow += total[0];
+	
+	for (int b = 0; b < bins; b++)
+	{
+		Hist->counts[b] += total[b + 1];
+	}
+	
+	Hist->overflow += total[bins + 1];
+	Hist->count += count - total[bins + 2];
+	
+	free(total);
+	free_reduce_source(Src);
+}
+
+static Histogram histogram_alloc(int bins, float min, float max, int adaptive, int absolute)
+{
+	assert(bins > 0);
+	
+	Histogram tempHist;
+	
+	tempHist.bins = bins;
+	tempHist.adaptive = adaptive;
+	tempHist.absolute = absolute;
+	tempHist.min = min;
+	tempHist.max = max;
+	tempHist.count = 0;
+	tempHist.underflow = 0;
+	tempHist.overflow = 0;
+	tempHist.counts = calloc(bins, sizeof(long long));
+	assert(tempHist.counts != NULL);
+	
+	return tempHist;
+}
+
+Histogram create_histogram(int bins, float min, float max)
+{
+	assert(max > min);
+	
+	return histogram_alloc(bins, min, max, 0, 0);
+}
+
+Histogram create_adaptive_histogram(int bins, int absolute)
+{
+	assert(bins % 2 == 0);
+	
+	return histogram_alloc(bins, 0.0f, 0.0f, 1, absolute != 0);
+}
+
+void free_histogram(Histogram *Hist)
+{
+	free(Hist->counts);
+	Hist->counts = NULL;
+	Hist->bins = 0;
+}
+
+void histogram_Vec_wCPU(Histogram *Hist, Vector *Vec_In)
+{
+	Reduce_Source tempSrc = reduce_source_Vec(Vec_In);
+	
+	histogram_source(Hist, &tempSrc);
+}
+
+void histogram_Mat_wCPU(Histogram *Hist, Matrix *Mat_In)
+{
+	Reduce_Source tempSrc = reduce_source_Mat(Mat_In, 1);
+	
+	histogram_source(Hist, &tempSrc);
+}
+
+void histogram_Tsr_wCPU(Histogram *Hist, Tensor *Tsr_In)
+{
+	Reduce_Source tempSrc = reduce_source_Tsr(Tsr_In, 1);
+	
+	histogram_source(Hist, &tempSrc);
+}
+
+void merge_histogram(Histogram *Hist, Histogram *Hist_In)
+{
+	assert(Hist->bins == Hist_In->bins && Hist->absolute == Hist_In->absolute);
+	
+	if (Hist_In->count == 0)
+	{
+		return;
+	}
+	
+	if (Hist->adaptive && Hist->count == 0)
+	{
+		Hist->min = Hist_In->min;
+		Hist->max = Hist_In->max;
+	}
+	
+	if (Hist->min == Hist_In->min && Hist->max == Hist_In->max)
+	{
+		for (int b = 0; b < Hist->bins; b++)
+		{
+			Hist->counts[b] += Hist_In->counts[b];
+		}
+	}
+	else
+	{
+		// Bins do not line up: widen to cover the other range, then move each of its
+		// bins to the bin holding its center
+		assert(Hist->adaptive);
+		
+		histogram_widen(Hist, Hist_In->min, Hist_In->max);
+		
+		float width_In = (Hist_In->max - Hist_In->min)/Hist_In->bins;
+		float scale = Hist->bins/(Hist->max - Hist->min);
+		
+		for (int b = 0; b < Hist_In->bins; b++)
+		{
+			float center = Hist_In->min + (b + 0.5f)*width_In;
+			int pos = (int)((center - Hist->min)*scale);
+			
+			pos = (pos < 0) ? 0 : (pos >= Hist->bins ? Hist->bins - 1 : pos);
+			Hist->counts[pos] += Hist_In->counts[b];
+		}
+	}
+	
+	Hist->underflow += Hist_In->underflow;
+	Hist->overflow += Hist_In->overflow;
+	Hist->count += Hist_In->count;
+}
+
+float histogram_quantile_wCPU(Histogram *Hist, float q)
+{
+	assert(q >= 0.0f && q <= 1.0f);
+	
+	if (Hist->count == 0)
+	{
+		return NAN;
+	}
+	
+	double target = (double)q*Hist->count;
+	double width = ((double)Hist->max - Hist->min)/Hist->bins;
+	long long cum = Hist->underflow;
+	
+	if (cum > 0 && target <= cum)
+	{
+		return Hist->min;
+	}
+	
+	// Values are taken as uniform within a bin
+	for (int b = 0; b < Hist->bins; b++)
+	{
+		if (Hist->counts[b] > 0 && cum + Hist->counts[b] >= target)
+		{
+			return (float)(Hist->min + (b + (target - cum)/Hist->counts[b])*width);
+		}
+		
+		cum += Hist->counts[b];
+	}
+	
+	return Hist->max;
+}
+
+// KL(P||Q) of the first clip bins against their quantization into quant_bins levels
+static double kl_divergence_clip(Histogram *Hist, int clip, int quant_bins, double *p, double *q)
+{
+	const long long *counts = Hist->counts;
+	double outliers = (double)Hist->overflow;
+	
+	for (int j = clip; j < Hist->bins; j++)
+	{
+		outliers += counts[j];
+	}
+	
+	// Reference distribution: clipped values saturate into the last kept bin
+	for (int j = 0; j < clip; j++)
+	{
+		p[j] = (double)counts[j];
+	}
+	
+	p[clip - 1] += outliers;
+	
+	// Candidate distribution: merge the kept bins into quant_bins levels, then spread each
+	// level evenly over the bins it covers that are not empty
+	for (int b = 0; b < quant_bins; b++)
+	{
+		int start = (int)((long)b*clip/quant_bins);
+		int end = (int)((long)(b + 1)*clip/quant_bins);
+		double sum = 0;
+		int nonzero = 0;
+		
+		for (int j = start; j < end; j++)
+		{
+			sum += counts[j];
+			nonzero += (p[j] != 0);
+		}
+		
+		for (int j = start; j < end; j++)
+		{
+			q[j] = (p[j] != 0) ? sum/nonzero : 0.0;
+		}
+	}
+	
+	double psum = 0, qsum = 0;
+	
+	for (int j = 0; j < clip; j++)
+	{
+		psum += p[j];
+		qsum += q[j];
+	}
+	
+	if (psum == 0 || qsum == 0)
+	{
+		return INFINITY;
+	}
+	
+	double kl = 0;
+	
+	for (int j = 0; j < clip; j++)
+	{
+		if (p[j] != 0)
+		{
+			double pn = p[j]/psum;
+			double qn = (q[j] != 0) ? q[j]/qsum : 1e-10;
+			
+			kl += pn*log(pn/qn);
+		}
+	}
+	
+	return kl;
+}
+
+float kl_threshold_wCPU(Histogram *Hist, int quant_bins)
+{
+	assert(Hist->min == 0.0f);
+	assert(quant_bins > 0 && quant_bins <= Hist->bins);
+	
+	int bins = Hist->bins;
+	
+	double *kl = malloc((bins + 1)*sizeof(double));
+	assert(kl != NULL);
+	
+	// Every candidate clip is independent
+	#pragma omp parallel
+	{
+		double *p = malloc(bins*sizeof(double));
+		double *q = malloc(bins*sizeof(double));
+		
+		#pragma omp for
+		for (int clip = quant_bins; clip <= bins; clip++)
+		{
+			kl[clip] = kl_divergence_clip(Hist, clip, quant_bins, p, q);
+		}
+		
+		free(p);
+		free(q);
+	}
+	
+	// Smallest divergence, the first one on ties
+	int best = quant_bins;
+	
+	for (int clip = quant_bins + 1; clip <= bins; clip++)
+	{
+		best = (kl[clip] < kl[best]) ? clip : best;
+	}
+	
+	free(kl);
+	
+	return Hist->min + (float)best*(Hist->max - Hist->min)/bins;
+}
+
+// Quantile sketch buckets are the float bit patterns cut to the exponent and the top
+// precision bits of the mantissa, i.e. log-linear buckets of relative width 2^-precision.
+// Negative values fill the lower half in reverse, so buckets are sorted by value.
+static int sketch_half(int precision)
+{
+	return (255 << precision) + 1;
+}
+
+static void sketch_index_block(const float *vals, int len, int *idx, int precision)
+{
+	int half = sketch_half(precision);
+	int shift = 23 - precision;
+	
+	for (int j = 0; j < len; j++)
+	{
+		union { float f; uint32_t i; } u;
+		
+		u.f = vals[j];
+		
+		uint32_t bits = u.i;
+		uint32_t abits = bits & 0x7fffffffu;
+		int mag = (int)(abits >> shift);
+		int pos = (bits >> 31) ? half - 1 - mag : half + mag;
+		
+		idx[j] = (abits > 0x7f800000u) ? 2*half : pos;
+	}
+}
+
+// Count the values of the source into the sketch, the source is released
+static void quantile_sketch_source(Quantile_Sketch *Sketch, Reduce_Source *Src)
+{
+	long count = Src->count;
+	
+	if (count == 0)
+	{
+		return;
+	}
+	
+	int slots = Sketch->buckets + 1;
+	long nparts = reduce_parts(Src);
+	
+	#pragma omp parallel if (nparts > 1)
+	{
+		long long *local = (nparts > 1) ? calloc(slots, sizeof(long long)) : NULL;
+		long long *counts = (local != NULL) ? local : Sketch->counts;
+		long long nan = 0;
+		int idx[HISTOGRAM_BLOCK];
+		
+		#pragma omp for
+		for (long c = 0; c < nparts; c++)
+		{
+			int len;
+			const float *chunk = reduce_part(Src, c, &len);
+			
+			for (int b = 0; b < len; b += HISTOGRAM_BLOCK)
+			{
+				int blocklen = (len - b < HISTOGRAM_BLOCK) ? len - b : HISTOGRAM_BLOCK;
+				
+				sketch_index_block(chunk + b, blocklen, idx, Sketch->precision);
+				
+				for (int t = 0; t < blocklen; t++)
+				{
+					counts[idx[t]]++;
+				}
+			}
+		}
+		
+		#pragma omp critical
+		{
+			if (local != NULL)
+			{
+				for (int b = 0; b < Sketch->buckets; b++)
+				{
+					Sketch->counts[b] += local[b];
+				}
+				
+				nan += local[Sketch->buckets];
+			}
+			else
+			{
+				nan += Sketch->counts[Sketch->buckets];
+				Sketch->counts[Sketch->buckets] = 0;
+			}
+			
+			Sketch->count -= nan;
+		}
+		
+		free(local);
+	}
+	
+	Sketch->count += count;
+	free_reduce_source(Src);
+}
+
+Quantile_Sketch create_quantile_sketch(int precision)
+{
+	assert(precision >= 0 && precision <= 10);
+	
+	Quantile_Sketch tempSketch;
+	
+	tempSketch.precision = precision;
+	tempSketch.buckets = 2*sketch_half(precision);
+	tempSketch.count = 0;
+	
+	// One extra slot takes the NaN values while counting
+	tempSketch.counts = calloc(tempSketch.buckets + 1, sizeof(long long));
+	assert(tempSketch.counts != NULL);
+	
+	return tempSketch;
+}
+
+void free_quantile_sketch(Quantile_Sketch *Sketch)
+{
+	free(Sketch->counts);
+	Sketch->counts = NULL;
+	Sketch->buckets = 0;
+}
+
+void quantile_sketch_Vec_wCPU(Quantile_Sketch *Sketch, Vector *Vec_In)
+{
+	Reduce_Source tempSrc = reduce_source_Vec(Vec_In);
+	
+	quantile_sketch_source(Sketch, &tempSrc);
+}
+
+void quantile_sketch_Mat_wCPU(Quantile_Sketch *Sketch, Matrix *Mat_In)
+{
+	Reduce_Source tempSrc = reduce_source_Mat(Mat_In, 1);
+	
+	quantile_sketch_source(Sketch, &tempSrc);
+}
+
+void quantile_sketch_Tsr_wCPU(Quantile_Sketch *Sketch, Tensor *Tsr_In)
+{
+	Reduce_Source tempSrc = reduce_source_Tsr(Tsr_In, 1);
+	
+	quantile_sketch_source(Sketch, &tempSrc);
+}
+
+void merge_quantile_sketch(Quantile_Sketch *Sketch, Quantile_Sketch *Sketch_In)
+{
+	assert(Sketch->precision == Sketch_In->precision);
+	
+	for (int b = 0; b < Sketch->buckets; b++)
+	{
+		Sketch->counts[b] += Sketch_In->counts[b];
+	}
+	
+	Sketch->count += Sketch_In->count;
+}
+
+float sketch_quantile_wCPU(Quantile_Sketch *Sketch, float q)
+{
+	assert(q >= 0.0f && q <= 1.0f);
+	
+	if (Sketch->count == 0)
+	{
+		return NAN;
+	}
+	
+	// Bucket holding the value of rank q*(count - 1)
+	long long rank = (long long)((double)q*(Sketch->count - 1));
+	long long cum = 0;
+	int pos = 0;
+	
+	while (cum + Sketch->counts[pos] <= rank)
+	{
+		cum += Sketch->counts[pos];
+		pos++;
+	}
+	
+	int half = sketch_half(Sketch->precision);
+	int shift = 23 - Sketch->precision;
+	int negative = pos < half;
+	uint32_t mag = (uint32_t)(negative ? half - 1 - pos : pos - half);
+	
+	// Middle of the bucket, its lower bound for the zero, last finite and infinite buckets
+	uint32_t lobits = mag << shift;
+	uint32_t hibits = (mag + 1) << shift;
+	float lo, hi;
+	
+	memcpy(&lo, &lobits, sizeof(lo));
+	memcpy(&hi, &hibits, sizeof(hi));
+	
+	float value = (mag == 0 || hibits >= 0x7f800000u) ? lo : 0.5f*(lo + hi);
+	
+	return negative ? -value : value;
+}
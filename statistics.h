@@ -48,17 +48,121 @@
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
+#include <float.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "vector.h"
 #include "matrix.h"
 #include "tensor.h"
 
+/**
+ * @brief	Define Moments
+ * 
+ * Summary statistics of a set of values, filled in one pass over the data
+ * (Welford) and mergeable between parts of the data (Chan et al.).
+ * Sample variance is M2/(count - 1), undefined (NAN) for fewer than two values.
+ */
+typedef struct Moments
+{
+	long long count;	/**< number of values */
+	double mean;		/**< mean of the values */
+	double M2;			/**< sum of squared differences from the mean */
+	float min, max;		/**< smallest and largest value */
+} Moments;
+
+/**
+ * @brief	Define Stats_Accumulator
+ * 
+ * Streaming statistics over data that arrives in chunks, e.g. a dataset that does not fit
+ * in memory. Holds the moments of each channel; one channel gives whole-data statistics.\n
+ * Accumulators of the same number of channels filled by different threads or processes
+ * can be merged with merge_stats_accumulator().
+ */
+typedef struct Stats_Accumulator
+{
+	int channels;		/**< number of channels */
+	Moments *moments;	/**< moments of each channel */
+} Stats_Accumulator;
+
+/**
+ * @brief	Define Histogram
+ * 
+ * Counts of values in bins of equal width over [min, max], the last bin including max.\n
+ * A fixed histogram keeps its range and counts values outside of it as underflow or
+ * overflow. An adaptive histogram takes its range from the first data and doubles it
+ * (merging pairs of bins) whenever later data falls outside. An absolute histogram bins
+ * |x| over [0, max], as used for symmetric quantization calibration. NaN is not counted.
+ */
+typedef struct Histogram
+{
+	int bins;					/**< number of bins */
+	int adaptive;				/**< 1 if the range grows with the data */
+	int absolute;				/**< 1 if magnitudes |x| are binned */
+	float min, max;				/**< range covered by the bins */
+	long long count;			/**< number of values, underflow and overflow included */
+	long long underflow;		/**< number of values below min */
+	long long overflow;			/**< number of values above max */
+	long long *counts;			/**< count of each bin */
+} Histogram;
+
+/**
+ * @brief	Define Quantile_Sketch
+ * 
+ * Mergeable sketch for approximate quantiles over any number of values.\n
+ * Values are counted in log-linear buckets made of the float exponent and the top
+ * precision bits of the mantissa, so any quantile is returned within a relative error
+ * of about 2^-(precision + 1), whatever the range of the data. Merging adds bucket
+ * counts and is exact. The sketch takes 2^(9 + precision) counters, e.g. 512 KB for a
+ * precision of 7 (0.4% error).
+ */
+typedef struct Quantile_Sketch
+{
+	int precision;				/**< number of mantissa bits kept */
+	int buckets;				/**< number of buckets */
+	long long count;			/**< number of values */
+	long long *counts;			/**< count of each bucket, sorted by value */
+} Quantile_Sketch;
+
+/**
+ * @brief	Calculate sum of a vector
+ * @param 	Vec_In
+ * @return 	float
+ * @note	The data is reduced in parallel over chunks of a fixed size and the chunk
+ * partials are merged in a fixed order, so the result is bitwise identical for
+ * any number of OpenMP threads
+ * 
+ * This function calculates and return the sum of all elements of a vector
+ */
+float sum_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	Calculate sum of a matrix
+ * @param 	Mat_In
+ * @return 	float
+ * @note	The result does not depend on the number of OpenMP threads, see sum_Vec_wCPU()
+ * 
+ * This function calculates and return the sum of all elements of a matrix
+ */
+float sum_Mat_wCPU(Matrix *Mat_In);
+
+/**
+ * @brief	Calculate sum of a tensor
+ * @param 	Tsr_In
+ * @return 	float
+ * @note	The result does not depend on the number of OpenMP threads, see sum_Vec_wCPU()
+ * 
+ * This function calculates and return the sum of all elements of a tensor
+ */
+float sum_Tsr_wCPU(Tensor *Tsr_In);
+
 /**
  * @brief	Calculate mean of a vector
  * @param 	Vec_In
  * @return 	float
  * 
- * This function calculates and return the mean of a vector
+ * This function calculates and return the mean of a vector, i.e. its sum over
+ * the number of elements, see sum_Vec_wCPU()
  */
 float mean_Vec_wCPU(Vector *Vec_In);
 
@@ -67,7 +171,8 @@ float mean_Vec_wCPU(Vector *Vec_In);
  * @param 	Mat_In
  * @return 	float
  * 
- * This function calculates and return the mean of a matrix
+ * This function calculates and return the mean of a matrix, i.e. its sum over
+ * the number of elements, see sum_Mat_wCPU()
  */
 float mean_Mat_wCPU(Matrix *Mat_In);
 
@@ -76,16 +181,48 @@ float mean_Mat_wCPU(Matrix *Mat_In);
  * @param 	Tsr_In
  * @return 	float
  * 
- * This function calculates and return the mean of a tensor
+ * This function calculates and return the mean of a tensor, i.e. its sum over
+ * the number of elements, see sum_Tsr_wCPU()
  */
 float mean_Tsr_wCPU(Tensor *Tsr_In);
 
+/**
+ * @brief	Calculate maximum of a vector
+ * @param 	Vec_In
+ * @return 	float
+ * 
+ * This function calculates and return the largest element of a vector,
+ * -INFINITY if it is empty. It is reduced in parallel like sum_Vec_wCPU()
+ */
+float max_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	Calculate maximum of a matrix
+ * @param 	Mat_In
+ * @return 	float
+ * 
+ * This function calculates and return the largest element of a matrix,
+ * -INFINITY if it is empty. It is reduced in parallel like sum_Vec_wCPU()
+ */
+float max_Mat_wCPU(Matrix *Mat_In);
+
+/**
+ * @brief	Calculate maximum of a tensor
+ * @param 	Tsr_In
+ * @return 	float
+ * 
+ * This function calculates and return the largest element of a tensor,
+ * -INFINITY if it is empty. It is reduced in parallel like sum_Vec_wCPU()
+ */
+float max_Tsr_wCPU(Tensor *Tsr_In);
+
 /**
  * @brief	Calculate variance of a vector
  * @param 	Vec_In
  * @return 	float
  * 
- * This function calculates and return the variance of a vector
+ * This function calculates and return the (sample) variance of a vector
+ * in a single pass, see moments_*_wCPU(), NAN if it has fewer than two elements
  */
 float variance_Vec_wCPU(Vector *Vec_In);
 
@@ -94,7 +231,8 @@ float variance_Vec_wCPU(Vector *Vec_In);
  * @param 	Mat_In
  * @return 	float
  * 
- * This function calculates and return the variance of a matrix
+ * This function calculates and return the (sample) variance of a matrix
+ * in a single pass, see moments_*_wCPU(), NAN if it has fewer than two elements
  */
 float variance_Mat_wCPU(Matrix *Mat_In);
 
@@ -103,7 +241,8 @@ float variance_Mat_wCPU(Matrix *Mat_In);
  * @param 	Tsr_In
  * @return 	float
  * 
- * This function calculates and return the variance of a tensor
+ * This function calculates and return the (sample) variance of a tensor
+ * in a single pass, see moments_*_wCPU(), NAN if it has fewer than two elements
  */
 float variance_Tsr_wCPU(Tensor *Tsr_In);
 
@@ -112,7 +251,8 @@ float variance_Tsr_wCPU(Tensor *Tsr_In);
  * @param 	Vec_In
  * @return 	float
  * 
- * This function calculates and return the standard deviation of a vector
+ * This function calculates and return the (sample) standard deviation of a vector,
+ * NAN if it has fewer than two elements
  */
 float std_dev_Vec_wCPU(Vector *Vec_In);
 
@@ -121,7 +261,8 @@ float std_dev_Vec_wCPU(Vector *Vec_In);
  * @param 	Mat_In
  * @return 	float
  * 
- * This function calculates and return the standard deviation of a matrix
+ * This function calculates and return the (sample) standard deviation of a matrix,
+ * NAN if it has fewer than two elements
  */
 float std_dev_Mat_wCPU(Matrix *Mat_In);
 
@@ -130,7 +271,8 @@ float std_dev_Mat_wCPU(Matrix *Mat_In);
  * @param 	Tsr_In
  * @return 	float
  * 
- * This function calculates and return the standard deviation of a tensor
+ * This function calculates and return the (sample) standard deviation of a tensor,
+ * NAN if it has fewer than two elements
  */
 float std_dev_Tsr_wCPU(Tensor *Tsr_In);
 
@@ -140,7 +282,8 @@ float std_dev_Tsr_wCPU(Tensor *Tsr_In);
  * @return 	vector
  * 
  * This function normalize the input vector and return a normalized new vector
- * of the same dimension
+ * of the same dimension. It reads the input twice: once for the moments and
+ * once to write the output.
  */
 Vector normalization_Vec_wCPU(Vector *Vec_In);
 
@@ -150,7 +293,8 @@ Vector normalization_Vec_wCPU(Vector *Vec_In);
  * @return 	matrix
  * 
  * This function normalize the input matrix and return a normalized new matrix
- * of the same dimension
+ * of the same dimension. It reads the input twice: once for the moments and
+ * once to write the output.
  */
 Matrix normalization_Mat_wCPU(Matrix *Mat_In);
 
@@ -160,8 +304,446 @@ Matrix normalization_Mat_wCPU(Matrix *Mat_In);
  * @return 	tensor
  * 
  * This function normalize the input tensor and return a normalized new tensor
- * of the same dimension
+ * of the same dimension. It reads the input twice: once for the moments and
+ * once to write the output.
  */
 Tensor normalization_Tsr_wCPU(Tensor *Tsr_In);
 
+/**
+ * @brief	Create empty moments
+ * @param 	None
+ * @return 	Moments
+ * 
+ * This function returns the moments of an empty set, i.e. the identity of merge_moments()
+ */
+Moments create_moments(void);
+
+/**
+ * @brief	Merge moments
+ * @param 	Mom_Acc
+ * @param 	Mom_In
+ * @return 	None
+ * 
+ * This function merges Mom_In into Mom_Acc, so that Mom_Acc describes the union
+ * of both sets of values.
+ */
+void merge_moments(Moments *Mom_Acc, Moments *Mom_In);
+
+/**
+ * @brief	Calculate moments of a vector
+ * @param 	Vec_In
+ * @return 	Moments
+ * 
+ * This function calculates count, mean, M2, min and max of a vector in a single pass.
+ * Chunks are reduced in parallel and merged in a fixed order, so the result does
+ * not depend on the number of OpenMP threads
+ */
+Moments moments_Vec_wCPU(Vector *Vec_In);
+
+/**
+ * @brief	Calculate moments of a matrix
+ * @param 	Mat_In
+ * @return 	Moments
+ * 
+ * This function calculates count, mean, M2, min and max of a matrix in a single pass.
+ * Chunks are reduced in parallel and merged in a fixed order, so the result does
+ * not depend on the number of OpenMP threads
+ */
+Moments moments_Mat_wCPU(Matrix *Mat_In);
+
+/**
+ * @brief	Calculate moments of a tensor
+ * @param 	Tsr_In
+ * @return 	Moments
+ * 
+ * This function calculates count, mean, M2, min and max of a tensor in a single pass.
+ * Chunks are reduced in parallel and merged in a fixed order, so the result does
+ * not depend on the number of OpenMP threads
+ */
+Moments moments_Tsr_wCPU(Tensor *Tsr_In);
+
+/**
+ * @brief	Batch normalization (inference) on tensor
+ * @param 	Tsr_In
+ * @param 	Vec_Gamma
+ * @param 	Vec_Beta
+ * @param 	Vec_Mean
+ * @param 	Vec_Var
+ * @param 	eps
+ * @return 	Tensor
+ * @note	
+ * 1. Vec_Mean and Vec_Var are the running mean and variance, their length must be the input depth
+ * 2. Vec_Gamma and Vec_Beta are optional (NULL for 1 and 0), otherwise their length must be the input depth
+ * 
+ * This function normalizes each channel k of the input tensor with learned statistics,
+ * i.e. gamma[k]*(x - mean[k])/sqrt(var[k] + eps) + beta[k], and return a new tensor of the
+ * same dimension. The per-channel terms are folded into one multiply-add per element.\n
+ * When batch normalization follows a convolution, fold_batchnorm_conv_wCPU() removes it
+ * from inference altogether.
+ */
+Tensor batchnorm_Tsr_wCPU(Tensor *Tsr_In, Vector *Vec_Gamma, Vector *Vec_Beta, Vector *Vec_Mean, Vector *Vec_Var, float eps);
+
+/**
+ * @brief	Layer normalization over matrix rows
+ * @param 	Mat_In
+ * @param 	Vec_Gamma
+ * @param 	Vec_Beta
+ * @param 	eps
+ * @return 	Matrix
+ * @note	Vec_Gamma and Vec_Beta are optional (NULL for 1 and 0), otherwise their length must be the matrix column
+ * 
+ * This function normalizes each row of the input matrix by its own mean and (population)
+ * variance, i.e. gamma[j]*(x - mean)/sqrt(var + eps) + beta[j], and return a new matrix of
+ * the same dimension.\n
+ * Moments and output are computed row by row, so the input is read once from memory and
+ * the output written once. Rows are computed in parallel.
+ */
+Matrix layernorm_Mat_wCPU(Matrix *Mat_In, Vector *Vec_Gamma, Vector *Vec_Beta, float eps);
+
+/**
+ * @brief	RMS normalization over matrix rows
+ * @param 	Mat_In
+ * @param 	Vec_Gamma
+ * @param 	eps
+ * @return 	Matrix
+ * @note	Vec_Gamma is optional (NULL for 1), otherwise its length must be the matrix column
+ * 
+ * This function scales each row of the input matrix by the inverse of its root mean square,
+ * i.e. gamma[j]*x/sqrt(mean(x*x) + eps), and return a new matrix of the same dimension.
+ * As layernorm_Mat_wCPU(), it reads the input and writes the output once.
+ */
+Matrix rmsnorm_Mat_wCPU(Matrix *Mat_In, Vector *Vec_Gamma, float eps);
+
+/**
+ * @brief	Layer normalization across tensor channels
+ * @param 	Tsr_In
+ * @param 	Vec_Gamma
+ * @param 	Vec_Beta
+ * @param 	eps
+ * @return 	Tensor
+ * @note	Vec_Gamma and Vec_Beta are optional (NULL for 1 and 0), otherwise their length must be the tensor depth
+ * 
+ * This function normalizes every pixel of the input tensor across its channels, i.e. 
+ * gamma[k]*(x - mean)/sqrt(var + eps) + beta[k] with the mean and (population) variance
+ * taken over the depth at that pixel, and return a new tensor of the same dimension.\n
+ * One row of pixels of all channels is processed at a time, in parallel over rows.
+ */
+Tensor layernorm_Tsr_wCPU(Tensor *Tsr_In, Vector *Vec_Gamma, Vector *Vec_Beta, float eps);
+
+/**
+ * @brief	RMS normalization across tensor channels
+ * @param 	Tsr_In
+ * @param 	Vec_Gamma
+ * @param 	eps
+ * @return 	Tensor
+ * @note	Vec_Gamma is optional (NULL for 1), otherwise its length must be the tensor depth
+ * 
+ * This function scales every pixel of the input tensor by the inverse root mean square of
+ * its channels, i.e. gamma[k]*x/sqrt(mean(x*x) + eps), and return a new tensor of the same
+ * dimension. Traversal is the same as layernorm_Tsr_wCPU().
+ */
+Tensor rmsnorm_Tsr_wCPU(Tensor *Tsr_In, Vector *Vec_Gamma, float eps);
+
+/**
+ * @brief	Create statistics accumulator
+ * @param 	channels
+ * @return 	Stats_Accumulator
+ * @note	channels must be more than 0
+ * 
+ * This function creates an empty accumulator of the given number of channels.
+ * Release it with free_stats_accumulator().
+ */
+Stats_Accumulator create_stats_accumulator(int channels);
+
+/**
+ * @brief	Reset statistics accumulator
+ * @param 	Acc
+ * @return 	None
+ * 
+ * This function empties the accumulator, keeping its number of channels
+ */
+void reset_stats_accumulator(Stats_Accumulator *Acc);
+
+/**
+ * @brief	Free statistics accumulator
+ * @param 	Acc
+ * @return 	None
+ */
+void free_stats_accumulator(Stats_Accumulator *Acc);
+
+/**
+ * @brief	Merge statistics accumulators
+ * @param 	Acc
+ * @param 	Acc_In
+ * @return 	None
+ * @note	Both accumulators must have the same number of channels
+ * 
+ * This function merges Acc_In into Acc channel by channel, see merge_moments()
+ */
+void merge_stats_accumulator(Stats_Accumulator *Acc, Stats_Accumulator *Acc_In);
+
+/**
+ * @brief	Accumulate vector into statistics
+ * @param 	Acc
+ * @param 	Vec_In
+ * @return 	None
+ * @note	The accumulator must have 1 channel, or one channel per vector element
+ * 
+ * This function adds the elements of the vector to the accumulator. With 1 channel
+ * all elements are samples of it, otherwise element j is one sample of channel j.
+ */
+void accumulate_Vec_wCPU(Stats_Accumulator *Acc, Vector *Vec_In);
+
+/**
+ * @brief	Accumulate matrix into statistics
+ * @param 	Acc
+ * @param 	Mat_In
+ * @return 	None
+ * @note	The accumulator must have 1 channel, or one channel per matrix column
+ * 
+ * This function adds the elements of the matrix to the accumulator. With 1 channel
+ * all elements are samples of it, otherwise every row is one sample and column j
+ * belongs to channel j.
+ */
+void accumulate_Mat_wCPU(Stats_Accumulator *Acc, Matrix *Mat_In);
+
+/**
+ * @brief	Accumulate tensor into statistics
+ * @param 	Acc
+ * @param 	Tsr_In
+ * @return 	None
+ * @note	The accumulator must have 1 channel, or one channel per tensor layer.
+ * 
+ * This function adds the elements of the tensor to the accumulator. With 1 channel
+ * all elements are samples of it, otherwise layer k belongs to channel k.
+ */
+void accumulate_Tsr_wCPU(Stats_Accumulator *Acc, Tensor *Tsr_In);
+
+/**
+ * @brief	Mean of accumulated statistics
+ * @param 	Acc
+ * @return 	Vector
+ * 
+ * This function returns the mean of each channel, NAN for an empty channel
+ */
+Vector accumulator_mean_wCPU(Stats_Accumulator *Acc);
+
+/**
+ * @brief	Variance of accumulated statistics
+ * @param 	Acc
+ * @return 	Vector
+ * 
+ * This function returns the (sample) variance of each channel, NAN for a channel
+ * with fewer than two values
+ */
+Vector accumulator_variance_wCPU(Stats_Accumulator *Acc);
+
+/**
+ * @brief	Standard deviation of accumulated statistics
+ * @param 	Acc
+ * @return 	Vector
+ * 
+ * This function returns the (sample) standard deviation of each channel, NAN for
+ * a channel with fewer than two values
+ */
+Vector accumulator_std_dev_wCPU(Stats_Accumulator *Acc);
+
+/**
+ * @brief	Minimum of accumulated statistics
+ * @param 	Acc
+ * @return 	Vector
+ * 
+ * This function returns the smallest value of each channel, INFINITY for an empty channel
+ */
+Vector accumulator_min_wCPU(Stats_Accumulator *Acc);
+
+/**
+ * @brief	Maximum of accumulated statistics
+ * @param 	Acc
+ * @return 	Vector
+ * 
+ * This function returns the largest value of each channel, -INFINITY for an empty channel
+ */
+Vector accumulator_max_wCPU(Stats_Accumulator *Acc);
+
+/**
+ * @brief	Create fixed histogram
+ * @param 	bins
+ * @param 	min
+ * @param 	max
+ * @return 	Histogram
+ * @note	bins must be more than 0 and max more than min
+ * 
+ * This function creates an empty histogram of bins bins of equal width over [min, max].
+ * Release it with free_histogram().
+ */
+Histogram create_histogram(int bins, float min, float max);
+
+/**
+ * @brief	Create adaptive histogram
+ * @param 	bins
+ * @param 	absolute
+ * @return 	Histogram
+ * @note	bins must be even and more than 0
+ * 
+ * This function creates an empty histogram whose range is set by the first data and
+ * doubled when needed to cover later data, so no value is lost to overflow. With
+ * absolute set, the magnitudes |x| are binned over [0, max].
+ */
+Histogram create_adaptive_histogram(int bins, int absolute);
+
+/**
+ * @brief	Free histogram
+ * @param 	Hist
+ * @return 	None
+ */
+void free_histogram(Histogram *Hist);
+
+/**
+ * @brief	Add vector to histogram
+ * @param 	Hist
+ * @param 	Vec_In
+ * @return 	None
+ * 
+ * This function counts the elements of the vector into the histogram. Bin positions
+ * are computed a block at a time in vectorized loops, and chunks are counted in parallel.
+ */
+void histogram_Vec_wCPU(Histogram *Hist, Vector *Vec_In);
+
+/**
+ * @brief	Add matrix to histogram
+ * @param 	Hist
+ * @param 	Mat_In
+ * @return 	None
+ * 
+ * This function counts the elements of the matrix into the histogram, see histogram_Vec_wCPU()
+ */
+void histogram_Mat_wCPU(Histogram *Hist, Matrix *Mat_In);
+
+/**
+ * @brief	Add tensor to histogram
+ * @param 	Hist
+ * @param 	Tsr_In
+ * @return 	None
+ * 
+ * This function counts the elements of the tensor into the histogram, see histogram_Vec_wCPU()
+ */
+void histogram_Tsr_wCPU(Histogram *Hist, Tensor *Tsr_In);
+
+/**
+ * @brief	Merge histograms
+ * @param 	Hist
+ * @param 	Hist_In
+ * @return 	None
+ * @note	Both histograms must have the same number of bins and absolute mode.
+ * Unless both ranges are the same, Hist must be adaptive
+ * 
+ * This function adds the counts of Hist_In to Hist. Histograms of the same range merge
+ * exactly; otherwise Hist is widened to cover Hist_In and every bin of Hist_In is added
+ * to the bin holding its center.
+ */
+void merge_histogram(Histogram *Hist, Histogram *Hist_In);
+
+/**
+ * @brief	Quantile from histogram
+ * @param 	Hist
+ * @param 	q
+ * @return 	float
+ * @note	q must be in [0, 1]
+ * 
+ * This function returns the value below which a fraction q of the counted values lie,
+ * interpolated linearly within the bin, e.g. q = 0.9999 for the 99.99th percentile.
+ * NAN for an empty histogram.
+ */
+float histogram_quantile_wCPU(Histogram *Hist, float q);
+
+/**
+ * @brief	KL-divergence calibration threshold
+ * @param 	Hist
+ * @param 	quant_bins
+ * @return 	float
+ * @note	
+ * 1. The histogram must start at 0, e.g. an absolute histogram
+ * 2. quant_bins must be in [1, Hist->bins], 128 for symmetric int8
+ * 
+ * This function searches the clipping threshold for quantization into quant_bins levels
+ * that loses the least information (entropy calibration).\n
+ * For every candidate number of kept bins, values beyond are saturated into the last
+ * kept bin (P), the kept bins are quantized into quant_bins levels and expanded back (Q),
+ * and KL(P||Q) is computed. Candidates are evaluated in parallel. The upper edge of the
+ * best candidate is returned; the quantization scale is threshold/(quant_bins - 1).
+ */
+float kl_threshold_wCPU(Histogram *Hist, int quant_bins);
+
+/**
+ * @brief	Create quantile sketch
+ * @param 	precision
+ * @return 	Quantile_Sketch
+ * @note	precision must be in [0, 10]
+ * 
+ * This function creates an empty sketch keeping precision mantissa bits, see Quantile_Sketch.
+ * Release it with free_quantile_sketch().
+ */
+Quantile_Sketch create_quantile_sketch(int precision);
+
+/**
+ * @brief	Free quantile sketch
+ * @param 	Sketch
+ * @return 	None
+ */
+void free_quantile_sketch(Quantile_Sketch *Sketch);
+
+/**
+ * @brief	Add vector to quantile sketch
+ * @param 	Sketch
+ * @param 	Vec_In
+ * @return 	None
+ * 
+ * This function counts the elements of the vector into the sketch. NaN is not counted.
+ */
+void quantile_sketch_Vec_wCPU(Quantile_Sketch *Sketch, Vector *Vec_In);
+
+/**
+ * @brief	Add matrix to quantile sketch
+ * @param 	Sketch
+ * @param 	Mat_In
+ * @return 	None
+ * 
+ * This function counts the elements of the matrix into the sketch. NaN is not counted.
+ */
+void quantile_sketch_Mat_wCPU(Quantile_Sketch *Sketch, Matrix *Mat_In);
+
+/**
+ * @brief	Add tensor to quantile sketch
+ * @param 	Sketch
+ * @param 	Tsr_In
+ * @return 	None
+ * 
+ * This function counts the elements of the tensor into the sketch. NaN is not counted.
+ */
+void quantile_sketch_Tsr_wCPU(Quantile_Sketch *Sketch, Tensor *Tsr_In);
+
+/**
+ * @brief	Merge quantile sketches
+ * @param 	Sketch
+ * @param 	Sketch_In
+ * @return 	None
+ * @note	Both sketches must have the same precision
+ * 
+ * This function adds the counts of Sketch_In to Sketch, exactly
+ */
+void merge_quantile_sketch(Quantile_Sketch *Sketch, Quantile_Sketch *Sketch_In);
+
+/**
+ * @brief	Quantile from sketch
+ * @param 	Sketch
+ * @param 	q
+ * @return 	float
+ * @note	q must be in [0, 1]
+ * 
+ * This function returns the value of rank q*(count - 1) among the counted values, within
+ * the relative error of the sketch. NAN for an empty sketch.
+ */
+float sketch_quantile_wCPU(Quantile_Sketch *Sketch, float q);
+
 #endif /* STATISTICS_H */
@@ -46,16 +46,25 @@ Tensor create_tensor(int Tsr_Row, int Tsr_Col, int Tsr_Depth)
 	T.row = Tsr_Row;
 	T.col = Tsr_Col;
 	T.depth = Tsr_Depth;
+	T.view = 0;
 	
 	T.vals = calloc(T.depth, sizeof(float **));
 	
-	for (int k = 0; k < T.depth; k++)
+	// Layers share one block of row pointers (owned by vals[0]) which point into
+	// one contiguous layer-major data block (owned by vals[0][0])
+	if (T.depth > 0 && T.row > 0)
 	{
-		T.vals[k] = calloc(T.row, sizeof(float *));
+		float **rows = calloc((size_t)T.depth * T.row, sizeof(float *));
+		float *data = calloc((size_t)T.depth * T.row * T.col, sizeof(float));
 		
-		for (int i = 0; i < T.row; i++)
+		for (int k = 0; k < T.depth; k++)
 		{
-			T.vals[k][i] = calloc(T.col, sizeof(float));
+			T.vals[k] = rows + (size_t)k * T.row;
+			
+			for (int i = 0; i < T.row; i++)
+			{
+				T.vals[k][i] = data + ((size_t)k * T.row + i) * T.col;
+			}
 		}
 	}
 	
@@ -148,14 +157,15 @@ void print_tensor_dim(Tensor *Tsr)
 
 void free_tensor(Tensor *Tsr)
 {
-    for(int k = 0; k < Tsr->depth; k++)
-    {
-		for(int i = 0; i < Tsr->row; i++)
+	if (Tsr->depth > 0 && Tsr->row > 0)
+	{
+		// A view owns its row pointers only, the values belong to its parent
+		if (!Tsr->view)
 		{
-			free(Tsr->vals[k][i]);
+			free(Tsr->vals[0][0]);
 		}
 		
-		free(Tsr->vals[k]);
+		free(Tsr->vals[0]);
 	}
 
     free(Tsr->vals);
@@ -179,3 +189,24 @@ Tensor copy_Tsr_wCPU(Tensor *Tsr_In)
     return tempTsr;
 }
 
+int is_contiguous_Tsr(Tensor *Tsr)
+{
+	if (Tsr->depth == 0 || Tsr->row == 0)
+	{
+		return 1;
+	}
+	
+	// Rows of all layers must follow each other in one block, as laid out by create_tensor
+	for (int k = 0; k < Tsr->depth; k++)
+	{
+		for (int i = 0; i < Tsr->row; i++)
+		{
+			if (Tsr->vals[k][i] != Tsr->vals[0][0] + ((size_t)k * Tsr->row + i) * Tsr->col)
+			{
+				return 0;
+			}
+		}
+	}
+	
+	return 1;
+}
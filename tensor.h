@@ -53,13 +53,17 @@
 /**
  * @brief Define Tensor
  *
- * Define tensor data structure
+ * Define tensor data structure.\n
+ * Tensors from create_tensor() are stored layer-major in one contiguous block:
+ * vals[0][0] is the start of the block and vals[k][i] == vals[0][0] + (k*row + i)*col.
+ * A view (view != 0) owns its row pointers only, free_tensor() leaves the values as is.
  * 
  */
 typedef struct Tensor
 {
     int depth, row, col;
     float ***vals;
+    int view;
 } Tensor;
 
 Tensor create_tensor(int Tsr_Row, int Tsr_Col, int Tsr_Depth);
@@ -70,5 +74,6 @@ void print_tensor(Tensor *Tsr);
 void print_tensor_dim(Tensor *Tsr);
 void free_tensor(Tensor *Tsr);
 Tensor copy_Tsr_wCPU(Tensor *Tsr_In);
+int is_contiguous_Tsr(Tensor *Tsr);
 
 #endif /* TENSOR_H */
@@ -44,6 +44,7 @@ Vector create_vector(int Vec_Len)
 	Vector V; 
 	
 	V.len = Vec_Len;  
+	V.view = 0;
 	
 	V.vals = calloc(V.len, sizeof(float));
 	
@@ -110,7 +111,11 @@ void print_vector_dim(Vector *Vec)
 
 void free_vector(Vector *Vec)
 {
-	free(Vec->vals);
+	// A view's values belong to its parent
+	if (!Vec->view)
+	{
+		free(Vec->vals);
+	}
 }
 
 Vector copy_Vec_wCPU(Vector *Vec_In)
@@ -53,13 +53,15 @@
 /**
  * @brief Define Vector
  *
- * Define vector data structure
+ * Define vector data structure.
+ * A view (view != 0) borrows its values from another object, free_vector() leaves them as is.
  * 
  */
 typedef struct Vector
 {
 	int len;		/**< define vector length as int */
 	float *vals;	/**< define vector values as float pointers */
+	int view;		/**< non-zero if vals is borrowed from another object */
 } Vector;
 
 /**